@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace efzda {
+
+// Fields of a SET_ACTIVITY activity; empty strings are left out.
+struct DiscordActivity {
+    std::string details;
+    std::string state;
+    std::string smallImageKey;
+    std::string smallImageText;
+    std::string largeImageKey;
+    std::string largeImageText;
+};
+
+// Append `s` as the inside of a JSON string: ", \ and control characters
+// are escaped, everything else (UTF-8 included) is copied as is. Clean runs
+// are found 16 bytes at a time with SSE2 where available.
+void append_json_escaped(std::string& out, const char* s, size_t n);
+
+// Builds SET_ACTIVITY frames (IPC header included) into one reusable
+// buffer, so a frame is a single write and steady-state updates do not
+// allocate.
+class ActivitySerializer {
+public:
+    explicit ActivitySerializer(uint32_t pid);
+
+    // Op 1 frame setting `activity`, or clearing it when nullptr. The
+    // reference stays valid until the next call.
+    const std::string& setActivity(const DiscordActivity* activity, const char* nonce);
+    // Hash of the activity JSON setActivity() would send (nonce excluded),
+    // so two requests can be compared without keeping their payloads.
+    // Reuses the frame buffer: invalidates the last setActivity() result.
+    uint64_t activityHash(const DiscordActivity* activity);
+
+private:
+    void appendActivity(const DiscordActivity* activity);
+    void appendField(bool& first, const char* key, size_t keyLen, const std::string& value);
+
+    std::string m_prefix; // {"cmd":"SET_ACTIVITY","args":{"pid":N,"activity":
+    std::string m_frame;
+};
+
+} // namespace efzda
@@ -1,20 +1,46 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
 namespace efzda {
 
+struct DiscordClientStats {
+    uint32_t sent = 0;      // requests written (a clear-then-update counts once)
+    uint32_t acked = 0;     // SET_ACTIVITY replies matched to their nonce
+    uint32_t rejected = 0;  // SET_ACTIVITY answered with ERROR
+    uint32_t lost = 0;      // sent, but the connection dropped or no reply came
+    uint32_t coalesced = 0; // requests replaced by a newer one before they were sent
+    uint32_t deferred = 0;  // times the writer waited for a SET_ACTIVITY token
+    uint32_t suppressed = 0; // requests dropped because Discord already shows that payload
+    uint32_t failed = 0;    // delivery attempts that failed (Discord unreachable)
+};
+
+// Rich Presence over Discord IPC. All I/O runs on a writer thread that
+// init() starts: updatePresence() and clearPresence() only drop the request
+// into a single-slot mailbox and return, and a request the writer has not
+// picked up yet is replaced by the next one (latest wins). A clear followed
+// by an update is sent as both, clear first. SET_ACTIVITY is held to
+// Discord's budget (ActivityRateLimiter); while out of tokens the request
+// waits in the mailbox, so a burst collapses into its final state. A
+// request whose activity matches what Discord last confirmed is not sent
+// at all unless it is forced.
 class DiscordClient {
 public:
+    // Starts the writer, which connects in the background and keeps
+    // retrying while Discord is not running. False only without an App ID.
     bool init(const std::string &appId);
     void updatePresence(const std::string &details, const std::string &state,
                         const std::string &smallImageKey = std::string(),
                         const std::string &smallImageText = std::string(),
                         const std::string &largeImageKey = std::string(),
-                        const std::string &largeImageText = std::string());
-    // Run Discord callbacks; call periodically from a loop.
+                        const std::string &largeImageText = std::string(),
+                        bool force = false); // send even if unchanged
+    // Kept for callers; replies are handled on the writer thread.
     void poll();
     void clearPresence();
+    // Sends a pending request if still connected, then stops the writer.
     void shutdown();
+    DiscordClientStats stats() const;
 };
 
 }
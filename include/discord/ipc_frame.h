@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace efzda {
+
+// Discord IPC frame: little-endian {uint32 op, uint32 length} followed by
+// `length` bytes of JSON.
+enum IpcOpcode : uint32_t {
+    kIpcHandshake = 0,
+    kIpcFrame = 1,
+    kIpcClose = 2,
+    kIpcPing = 3,
+    kIpcPong = 4,
+};
+
+struct IpcFrame {
+    uint32_t op = 0;
+    std::string json;
+};
+
+// Header and payload in one buffer, so a frame goes out in one write.
+std::string encode_ipc_frame(uint32_t op, const std::string& json);
+
+// Streaming decoder for frames read from the transport in arbitrary chunks.
+class IpcFrameDecoder {
+public:
+    // Discord's replies are small; anything larger means the stream is out of sync.
+    static constexpr uint32_t kMaxPayload = 64 * 1024;
+
+    void feed(const void* data, size_t size);
+    // Next complete frame; false when more bytes are needed or the stream
+    // failed (unknown opcode or oversized frame; see failed()).
+    bool next(IpcFrame& frame);
+    bool failed() const { return m_failed; }
+    void reset();
+
+private:
+    std::string m_buf;
+    size_t m_pos = 0;
+    bool m_failed = false;
+};
+
+// Top-level string member `key` of a JSON object, unescaped. False when it
+// is missing, not a string (e.g. null) or the text is not an object.
+// Nested objects are skipped, so "data":{"evt":...} does not match "evt".
+bool json_top_level_string(const std::string& json, const char* key, std::string& out);
+
+} // namespace efzda
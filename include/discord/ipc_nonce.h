@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace efzda {
+
+// Nonces for IPC commands: "<8 hex digits>-<counter>". The prefix is random
+// per generator (one per process), the counter counts up from 1, so nonces
+// stay unique across reconnects and a reply maps back to the sequence
+// number of its command without keeping the strings around.
+class NonceGenerator {
+public:
+    // "xxxxxxxx-" + up to 10 digits + NUL
+    static constexpr size_t kMaxLen = 20;
+
+    NonceGenerator();
+    explicit NonceGenerator(uint32_t prefix);
+
+    // Write the next nonce into `out` and return its sequence number.
+    uint32_t next(char (&out)[kMaxLen]);
+    // Sequence number of a nonce this generator produced; false for
+    // anything else (other prefix, malformed, null).
+    bool sequenceOf(const std::string& nonce, uint32_t& seq) const;
+
+private:
+    char m_prefix[10]; // "xxxxxxxx-"
+    uint32_t m_counter = 0;
+};
+
+} // namespace efzda
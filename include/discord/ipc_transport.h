@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace efzda {
+
+// Byte stream to the local Discord client. Backends differ only in how they
+// find and open the endpoint; framing and the handshake live in
+// discord_client_stub.cpp and are shared by all of them.
+class IpcTransport {
+public:
+    virtual ~IpcTransport() = default;
+    // Short backend name for logs.
+    virtual const char* name() const = 0;
+    // Try each discord-ipc-N endpoint once; true when one accepted.
+    virtual bool connect() = 0;
+    // Write all `size` bytes or fail; a failed write leaves the transport
+    // open, the caller decides whether to reconnect.
+    virtual bool write(const void* data, size_t size) = 0;
+    // Non-blocking: up to `size` bytes that are already waiting. Returns the
+    // count, 0 when nothing is waiting, -1 when the peer closed or the read
+    // failed.
+    virtual long read(void* data, size_t size) = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+};
+
+#ifdef _WIN32
+// \\.\pipe\discord-ipc-N: the Windows client, or a Wine bridge relaying to
+// the Linux one.
+class NamedPipeTransport final : public IpcTransport {
+public:
+    ~NamedPipeTransport() override { close(); }
+    const char* name() const override { return "named-pipe"; }
+    bool connect() override;
+    bool write(const void* data, size_t size) override;
+    long read(void* data, size_t size) override;
+    void close() override;
+    bool isOpen() const override { return m_pipe != nullptr; }
+
+private:
+    void* m_pipe = nullptr; // HANDLE
+};
+#endif
+
+// The Linux client's AF_UNIX socket, discord-ipc-N under the runtime
+// directory (see discord_ipc_socket_paths). On Windows this goes through
+// Winsock's AF_UNIX support, which Wine maps onto host sockets, so a game
+// under Wine/Proton reaches the native client without a bridge process.
+class UnixSocketTransport final : public IpcTransport {
+public:
+    // Directories to search instead of the environment (tests).
+    explicit UnixSocketTransport(std::vector<std::string> baseDirs = {}) : m_baseDirs(std::move(baseDirs)) {}
+    ~UnixSocketTransport() override { close(); }
+    const char* name() const override { return "unix-socket"; }
+    bool connect() override;
+    bool write(const void* data, size_t size) override;
+    long read(void* data, size_t size) override;
+    void close() override;
+    bool isOpen() const override { return m_socket != kNoSocket; }
+    // Unix path of the connected socket, empty when closed.
+    const std::string& path() const { return m_path; }
+
+private:
+    static constexpr uintptr_t kNoSocket = ~uintptr_t(0);
+    std::vector<std::string> m_baseDirs;
+    uintptr_t m_socket = kNoSocket; // SOCKET / fd
+    std::string m_path;
+};
+
+// Unix socket paths the Discord client may listen on, in connect order:
+// discord-ipc-0..9 in each base directory, then in its flatpak and snap
+// subdirectories. Base directories are $XDG_RUNTIME_DIR, $TMPDIR and /tmp
+// unless given; entries that are not absolute Unix paths are skipped.
+std::vector<std::string> discord_ipc_socket_paths(const std::vector<std::string>& baseDirs = {});
+
+} // namespace efzda
@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace efzda {
+
+// Discord accepts about 5 SET_ACTIVITY commands per 20 seconds per client.
+constexpr uint32_t kActivityBurst = 5;
+constexpr uint32_t kActivityWindowMs = 20000;
+
+// Token bucket for SET_ACTIVITY where each spent token comes back windowMs
+// after it was spent, so no windowMs span ever holds more than `burst`
+// commands. Time is passed in (GetTickCount64 in the writer), which keeps
+// it independent of the clock.
+class ActivityRateLimiter {
+public:
+    explicit ActivityRateLimiter(uint32_t burst = kActivityBurst, uint32_t windowMs = kActivityWindowMs);
+
+    // Milliseconds until `tokens` can be spent at once; 0 when they can now.
+    uint64_t waitMs(uint64_t nowMs, uint32_t tokens = 1);
+    // Spend `tokens` at nowMs. The caller checks waitMs() first.
+    void take(uint64_t nowMs, uint32_t tokens = 1);
+    uint32_t available(uint64_t nowMs);
+
+private:
+    static constexpr uint32_t kMaxBurst = 16;
+    void expire(uint64_t nowMs);
+
+    uint32_t m_burst;
+    uint32_t m_windowMs;
+    std::array<uint64_t, kMaxBurst> m_spentAt{}; // ring, oldest at m_head
+    uint32_t m_head = 0;
+    uint32_t m_count = 0;
+};
+
+} // namespace efzda
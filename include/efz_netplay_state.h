@@ -18,6 +18,9 @@
 //      auto fn = (const EFZNetplayState*(__cdecl*)(void))
 //                GetProcAddress(mod, "EFZNetplay_GetState");
 //
+// Change notification (optional) — named event "EFZNetplay_StateChanged",
+// see EFZ_NETPLAY_STATE_EVENT_NAME.
+//
 // Compatibility:
 //   - Check magic  == EFZ_NETPLAY_STATE_MAGIC   before reading.
 //   - Check version <= your supported max.
@@ -38,6 +41,13 @@ extern "C" {
 #define EFZ_NETPLAY_STATE_VERSION     7u
 // Well-known name for the named shared memory block.
 #define EFZ_NETPLAY_STATE_SHM_NAME    "EFZNetplay_State"
+// Optional change notification: an auto-reset named event. Consumers create
+// it (CreateEventA(NULL, FALSE, FALSE, name)) so it exists before the writer
+// starts; the writer opens it and calls SetEvent() once after creating the
+// shared memory block and whenever a field other than lastUpdateTick /
+// stateSeq changes. Consumers must keep polling for writers that never
+// signal it. With several consumers only one is woken per signal.
+#define EFZ_NETPLAY_STATE_EVENT_NAME  "EFZNetplay_StateChanged"
 
 // ---------------------------------------------------------------------------
 // Capability bits — each bit indicates a field group is actively populated.
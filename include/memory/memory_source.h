@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace efzda {
+
+// Read accounting for a memory backend. The provider resets it once per poll
+// so the numbers describe a single GameStateProvider::get() call.
+struct MemoryReadStats {
+    uint32_t reads = 0;     // read() calls that reached this source
+    uint32_t syscalls = 0;  // kernel round trips issued to satisfy them
+    uint64_t bytes = 0;     // bytes requested
+    uint32_t failures = 0;  // reads that returned false
+};
+
+// Abstract byte source for game memory. Addresses are absolute in the
+// target address space (the DLL runs inside efz.exe, so that is our own).
+class MemorySource {
+public:
+    virtual ~MemorySource() = default;
+    // Copy `size` bytes at `address` into `out`. Returns false when any byte
+    // of the range is unreadable; `out` is then unspecified.
+    virtual bool read(uintptr_t address, void* out, size_t size) = 0;
+
+    const MemoryReadStats& stats() const { return m_stats; }
+    void resetStats() { m_stats = MemoryReadStats{}; }
+
+protected:
+    MemoryReadStats m_stats{};
+};
+
+#ifdef _WIN32
+// ReadProcessMemory(GetCurrentProcess()) backend: one syscall per read.
+class ProcessMemorySource final : public MemorySource {
+public:
+    bool read(uintptr_t address, void* out, size_t size) override;
+};
+#endif
+
+// Heap-backed fake address space used to exercise read plans without a game
+// process (unit tests, benchmarks, offline replays). Each mapped block is an
+// independent region; reads that straddle two blocks fail like they would at
+// an unmapped page boundary. Every read counts as one simulated syscall.
+class FakeMemorySource final : public MemorySource {
+public:
+    // Map `size` zero-filled bytes at `address`, replacing any block there.
+    void map(uintptr_t address, size_t size);
+    // Copy bytes into an already mapped range. Returns false if unmapped.
+    bool write(uintptr_t address, const void* data, size_t size);
+    template <typename T>
+    bool writeValue(uintptr_t address, const T& value) { return write(address, &value, sizeof(T)); }
+    void clear() { m_blocks.clear(); }
+
+    bool read(uintptr_t address, void* out, size_t size) override;
+
+private:
+    const std::vector<uint8_t>* find(uintptr_t address, size_t size, uintptr_t& blockStart) const;
+
+    std::map<uintptr_t, std::vector<uint8_t>> m_blocks;
+};
+
+} // namespace efzda
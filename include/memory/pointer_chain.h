@@ -0,0 +1,283 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "memory/memory_source.h"
+#include "memory/read_plan.h"
+
+namespace efzda {
+
+// Compile-time pointer chains.
+//
+//   using GameMode = Chain<ReadRoot::Efz, Off<0x39010C>, Deref, Off<0x1364>, uint8_t>;
+//
+// reads the pointer at efz.exe+0x39010C and then the byte at ptr+0x1364.
+// Steps are folded at compile time into one offset per hop, so every chain
+// instantiates its own reader with the offsets baked in. The last template
+// argument is the value type.
+template <uintptr_t V>
+struct Off {
+    static constexpr uintptr_t value = V;
+};
+struct Deref {};
+
+namespace chain_detail {
+
+enum class StepKind : uint8_t { Offset, Deref, Value };
+
+struct Step {
+    StepKind kind;
+    uintptr_t value;
+};
+
+template <typename S>
+struct IsOff : std::false_type {};
+template <uintptr_t V>
+struct IsOff<Off<V>> : std::true_type {};
+
+template <typename S>
+constexpr Step describe() {
+    if constexpr (IsOff<S>::value) return Step{StepKind::Offset, S::value};
+    else if constexpr (std::is_same<S, Deref>::value) return Step{StepKind::Deref, 0};
+    else return Step{StepKind::Value, 0};
+}
+
+template <typename... Ts>
+struct Last;
+template <typename T>
+struct Last<T> { using type = T; };
+template <typename T, typename... Ts>
+struct Last<T, Ts...> : Last<Ts...> {};
+
+// Exactly one value type, and it is the last step.
+template <size_t N>
+constexpr bool well_formed(const std::array<Step, N>& steps) {
+    if (N == 0 || steps[N - 1].kind != StepKind::Value) return false;
+    for (size_t i = 0; i + 1 < N; ++i)
+        if (steps[i].kind == StepKind::Value) return false;
+    return true;
+}
+
+template <size_t N>
+constexpr size_t count_derefs(const std::array<Step, N>& steps) {
+    size_t n = 0;
+    for (size_t i = 0; i < N; ++i)
+        if (steps[i].kind == StepKind::Deref) ++n;
+    return n;
+}
+
+// offsets[0] is added to the module base; offsets[k] to the k-th pointer.
+template <size_t Hops, size_t N>
+constexpr std::array<uintptr_t, Hops> fold_offsets(const std::array<Step, N>& steps) {
+    std::array<uintptr_t, Hops> out{};
+    size_t hop = 0;
+    for (size_t i = 0; i < N; ++i) {
+        if (steps[i].kind == StepKind::Offset) out[hop] += steps[i].value;
+        else if (steps[i].kind == StepKind::Deref) ++hop;
+    }
+    return out;
+}
+
+template <size_t To, size_t From>
+constexpr std::array<uintptr_t, To> pad(const std::array<uintptr_t, From>& in) {
+    std::array<uintptr_t, To> out{};
+    for (size_t i = 0; i < From; ++i) out[i] = in[i];
+    return out;
+}
+
+// Shared-prefix table for a ChainSet. Node n is the pointer stored at
+// (parent node, or module base when parent < 0) + offset.
+template <size_t N, size_t MaxNodes>
+struct SetLayout {
+    std::array<int, MaxNodes> nodeParent{};
+    std::array<ReadRoot, MaxNodes> nodeRoot{};
+    std::array<uintptr_t, MaxNodes> nodeOffset{};
+    size_t nodeCount = 0;
+    std::array<int, N> leafParent{};
+    std::array<uintptr_t, N> leafOffset{};
+    std::array<int, N> leafNode{}; // pointer-sized leaf that is also a node
+};
+
+template <size_t N, size_t MaxNodes>
+constexpr int find_node(const SetLayout<N, MaxNodes>& l, int parent, ReadRoot root, uintptr_t offset) {
+    for (size_t n = 0; n < l.nodeCount; ++n) {
+        if (l.nodeParent[n] == parent && l.nodeOffset[n] == offset && (parent >= 0 || l.nodeRoot[n] == root))
+            return static_cast<int>(n);
+    }
+    return -1;
+}
+
+template <size_t N, size_t MaxHops, size_t MaxNodes>
+constexpr SetLayout<N, MaxNodes> build_layout(
+    const std::array<ReadRoot, N>& roots,
+    const std::array<size_t, N>& hops,
+    const std::array<std::array<uintptr_t, MaxHops>, N>& offsets,
+    const std::array<bool, N>& pointerSized) {
+    SetLayout<N, MaxNodes> l{};
+    for (size_t c = 0; c < N; ++c) {
+        int parent = -1;
+        for (size_t h = 0; h + 1 < hops[c]; ++h) {
+            int n = find_node(l, parent, roots[c], offsets[c][h]);
+            if (n < 0) {
+                const size_t idx = l.nodeCount++;
+                l.nodeParent[idx] = parent;
+                l.nodeRoot[idx] = roots[c];
+                l.nodeOffset[idx] = offsets[c][h];
+                n = static_cast<int>(idx);
+            }
+            parent = n;
+        }
+        l.leafParent[c] = parent;
+        l.leafOffset[c] = offsets[c][hops[c] - 1];
+    }
+    for (size_t c = 0; c < N; ++c) {
+        l.leafNode[c] = pointerSized[c]
+            ? find_node(l, l.leafParent[c], roots[c], l.leafOffset[c])
+            : -1;
+    }
+    return l;
+}
+
+} // namespace chain_detail
+
+template <ReadRoot Root, typename... Steps>
+struct Chain {
+    using Value = typename chain_detail::Last<Steps...>::type;
+    static_assert(std::is_trivially_copyable<Value>::value, "chain value must be trivially copyable");
+
+    static constexpr std::array<chain_detail::Step, sizeof...(Steps)> kSteps{{chain_detail::describe<Steps>()...}};
+    static_assert(chain_detail::well_formed(kSteps), "Chain<Root, Off<>/Deref..., ValueType>: value type must come last");
+
+    static constexpr ReadRoot kRoot = Root;
+    static constexpr size_t kDerefs = chain_detail::count_derefs(kSteps);
+    static constexpr std::array<uintptr_t, kDerefs + 1> kOffsets = chain_detail::fold_offsets<kDerefs + 1>(kSteps);
+
+    static constexpr uintptr_t offset(size_t hop) { return kOffsets[hop]; }
+
+    // Walks the chain. Null intermediate pointers end the walk. `address`
+    // receives the final field address when the walk got that far.
+    static bool read(MemorySource& src, const uintptr_t (&roots)[kReadRootCount], Value& out,
+                     uintptr_t* address = nullptr) {
+        uintptr_t addr = roots[static_cast<size_t>(Root)];
+        if (!addr) return false;
+        addr += kOffsets[0];
+        for (size_t hop = 1; hop < kOffsets.size(); ++hop) {
+            uintptr_t ptr = 0;
+            if (!src.read(addr, &ptr, sizeof(ptr)) || !ptr) return false;
+            addr = ptr + kOffsets[hop];
+        }
+        if (address) *address = addr;
+        return src.read(addr, &out, sizeof(Value));
+    }
+};
+
+// True if chains A and B dereference the same pointers for their first
+// `hops` hops (same module, same offsets).
+template <typename A, typename B>
+constexpr bool chains_share_prefix(size_t hops) {
+    if (A::kRoot != B::kRoot || hops > A::kDerefs || hops > B::kDerefs) return false;
+    for (size_t h = 0; h < hops; ++h)
+        if (A::kOffsets[h] != B::kOffsets[h]) return false;
+    return true;
+}
+
+// Declares a chain in a read plan; returns the id of its final field.
+// Chains sharing a prefix share the pointer fields (ReadPlanBuilder folds
+// identical declarations).
+template <typename C>
+ReadFieldId add_chain(ReadPlanBuilder& b) {
+    if constexpr (C::kDerefs == 0) {
+        return b.add<typename C::Value>(C::kRoot, C::kOffsets[0]);
+    } else {
+        ReadFieldId id = b.add<uintptr_t>(C::kRoot, C::kOffsets[0]);
+        for (size_t hop = 1; hop + 1 < C::kOffsets.size(); ++hop) id = b.addIndirect<uintptr_t>(id, C::kOffsets[hop]);
+        return b.addIndirect<typename C::Value>(id, C::kOffsets.back());
+    }
+}
+
+// A group of chains resolved together in one pass. Pointer hops shared by
+// several chains are computed once at compile time and read once at run
+// time; a pointer-sized chain that ends exactly on a shared pointer reuses
+// that read instead of issuing another one.
+template <typename... Cs>
+class ChainSet {
+public:
+    static constexpr size_t kCount = sizeof...(Cs);
+    static_assert(kCount > 0, "empty ChainSet");
+
+    struct Result {
+        std::tuple<typename Cs::Value...> values{};
+        std::array<bool, kCount> ok{};
+        std::array<uintptr_t, kCount> address{}; // 0 if the walk stopped early
+    };
+
+private:
+    static constexpr size_t kMaxHops = std::max({Cs::kOffsets.size()...});
+    static constexpr size_t kMaxNodes = (size_t(0) + ... + Cs::kDerefs);
+    static constexpr std::array<ReadRoot, kCount> kRoots{{Cs::kRoot...}};
+    static constexpr std::array<size_t, kCount> kHops{{Cs::kOffsets.size()...}};
+    static constexpr std::array<std::array<uintptr_t, kMaxHops>, kCount> kOffsets{
+        {chain_detail::pad<kMaxHops>(Cs::kOffsets)...}};
+    static constexpr std::array<bool, kCount> kPointerSized{{(sizeof(typename Cs::Value) == sizeof(uintptr_t))...}};
+
+public:
+    static constexpr chain_detail::SetLayout<kCount, kMaxNodes> kLayout =
+        chain_detail::build_layout<kCount, kMaxHops, kMaxNodes>(kRoots, kHops, kOffsets, kPointerSized);
+
+    // Distinct pointer reads per resolve() (before leaf reads).
+    static constexpr size_t pointerReads() { return kLayout.nodeCount; }
+
+    static void resolve(MemorySource& src, const uintptr_t (&roots)[kReadRootCount], Result& r) {
+        std::array<uintptr_t, kMaxNodes> node{}; // 0 = unresolved
+        std::array<bool, kMaxNodes> nodeRead{};
+        for (size_t n = 0; n < kLayout.nodeCount; ++n) {
+            const int parent = kLayout.nodeParent[n];
+            const uintptr_t base = parent < 0 ? roots[static_cast<size_t>(kLayout.nodeRoot[n])] : node[static_cast<size_t>(parent)];
+            if (!base) continue;
+            uintptr_t v = 0;
+            if (src.read(base + kLayout.nodeOffset[n], &v, sizeof(v))) {
+                nodeRead[n] = true;
+                node[n] = v;
+            }
+        }
+        resolveLeaves(src, roots, node, nodeRead, r, std::index_sequence_for<Cs...>{});
+    }
+
+private:
+    template <size_t... I>
+    static void resolveLeaves(MemorySource& src, const uintptr_t (&roots)[kReadRootCount],
+                              const std::array<uintptr_t, kMaxNodes>& node,
+                              const std::array<bool, kMaxNodes>& nodeRead, Result& r, std::index_sequence<I...>) {
+        (resolveLeaf<I>(src, roots, node, nodeRead, r), ...);
+    }
+
+    template <size_t I>
+    static void resolveLeaf(MemorySource& src, const uintptr_t (&roots)[kReadRootCount],
+                            const std::array<uintptr_t, kMaxNodes>& node,
+                            const std::array<bool, kMaxNodes>& nodeRead, Result& r) {
+        auto& out = std::get<I>(r.values);
+        r.ok[I] = false;
+        r.address[I] = 0;
+        const int parent = kLayout.leafParent[I];
+        const uintptr_t base = parent < 0 ? roots[static_cast<size_t>(kRoots[I])] : node[static_cast<size_t>(parent)];
+        if (!base) return;
+        r.address[I] = base + kLayout.leafOffset[I];
+        const int shared = kLayout.leafNode[I];
+        if (shared >= 0) {
+            if (nodeRead[static_cast<size_t>(shared)]) {
+                std::memcpy(&out, &node[static_cast<size_t>(shared)], sizeof(out));
+                r.ok[I] = true;
+            }
+            return;
+        }
+        r.ok[I] = src.read(r.address[I], &out, sizeof(out));
+    }
+};
+
+} // namespace efzda
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "memory/memory_source.h"
+
+namespace efzda {
+
+// Module bases a plan can anchor root fields on.
+enum class ReadRoot : uint8_t { Efz = 0, Revival = 1 };
+constexpr size_t kReadRootCount = 2;
+
+using ReadFieldId = uint16_t;
+constexpr ReadFieldId kInvalidReadField = 0xFFFF;
+
+struct ReadPlanOptions {
+    // Fields under the same anchor closer than this are fetched by one read;
+    // copying a few hundred extra bytes is far cheaper than another syscall.
+    uint32_t maxGap = 256;
+    // Upper bound for a single coalesced span.
+    uint32_t maxSpan = 4096;
+};
+
+class ReadPlan;
+
+// Per-poll output of ReadPlan::execute(). Holds one contiguous buffer with
+// every span and hands out typed views of the declared fields.
+class ReadPlanResult {
+public:
+    bool valid(ReadFieldId id) const;
+    // Raw bytes of a field, or nullptr if it could not be read this poll.
+    const uint8_t* bytes(ReadFieldId id) const;
+    template <typename T>
+    bool get(ReadFieldId id, T& out) const {
+        const uint8_t* p = bytes(id);
+        if (!p || fieldSize(id) != sizeof(T)) return false;
+        std::memcpy(&out, p, sizeof(T));
+        return true;
+    }
+    uint32_t fieldSize(ReadFieldId id) const;
+    // Absolute address a field was read from (0 if its anchor was unresolved).
+    uintptr_t address(ReadFieldId id) const;
+
+    // Serve an arbitrary [address, address+size) range from the snapshot.
+    // Used by readers that address memory directly instead of by field id.
+    bool lookup(uintptr_t address, void* out, size_t size) const;
+
+    // FNV-1a over every field's validity and bytes (not the gaps between
+    // coalesced fields), for cheap "did anything we read change" checks.
+    uint64_t fingerprint() const;
+
+    uint32_t spansRead() const { return m_spansRead; }
+    uint32_t spansFailed() const { return m_spansFailed; }
+
+private:
+    friend class ReadPlan;
+    const ReadPlan* m_plan = nullptr;
+    std::vector<uint8_t> m_buffer;
+    std::vector<uintptr_t> m_spanBase;  // absolute address per span, 0 = unresolved
+    std::vector<uint8_t> m_spanOk;      // whole span read in one go
+    std::vector<uint8_t> m_fieldOk;
+    uint32_t m_spansRead = 0;
+    uint32_t m_spansFailed = 0;
+};
+
+// Compiled set of fields: one read per coalesced span, executed in pointer
+// hop order so indirect fields see the pointers fetched earlier in the poll.
+class ReadPlan {
+public:
+    struct Span {
+        bool indirect = false;
+        ReadRoot root = ReadRoot::Efz;        // anchor when !indirect
+        ReadFieldId parent = kInvalidReadField; // pointer field when indirect
+        uintptr_t offset = 0;                 // relative to the anchor
+        uint32_t size = 0;
+        uint32_t bufferOffset = 0;
+        uint16_t depth = 0;
+        uint16_t firstField = 0;              // index into m_order
+        uint16_t fieldCount = 0;
+    };
+    struct Field {
+        uint16_t span = 0;
+        uint32_t offsetInSpan = 0;
+        uint32_t size = 0;
+    };
+
+    size_t spanCount() const { return m_spans.size(); }
+    size_t fieldCount() const { return m_fields.size(); }
+    uint32_t bufferSize() const { return m_bufferSize; }
+    const Span& span(size_t i) const { return m_spans[i]; }
+
+    void execute(MemorySource& source, const uintptr_t (&roots)[kReadRootCount], ReadPlanResult& out) const;
+
+private:
+    friend class ReadPlanBuilder;
+    friend class ReadPlanResult;
+    std::vector<Span> m_spans;       // ordered by depth
+    std::vector<Field> m_fields;     // indexed by ReadFieldId
+    std::vector<ReadFieldId> m_order; // fields grouped per span
+    uint32_t m_bufferSize = 0;
+};
+
+// Declarative field list for one version profile. Identical declarations are
+// folded to one id, so readers can ask for the same field independently.
+class ReadPlanBuilder {
+public:
+    // Field at module base + offset.
+    ReadFieldId add(ReadRoot root, uintptr_t offset, uint32_t size);
+    // Field at (*parent) + offset; `parent` must be pointer-sized.
+    ReadFieldId addIndirect(ReadFieldId parent, uintptr_t offset, uint32_t size);
+
+    template <typename T>
+    ReadFieldId add(ReadRoot root, uintptr_t offset) { return add(root, offset, sizeof(T)); }
+    template <typename T>
+    ReadFieldId addIndirect(ReadFieldId parent, uintptr_t offset) { return addIndirect(parent, offset, sizeof(T)); }
+
+    ReadPlan compile(const ReadPlanOptions& options = {}) const;
+
+private:
+    struct Decl {
+        bool indirect;
+        ReadRoot root;
+        ReadFieldId parent;
+        uintptr_t offset;
+        uint32_t size;
+        uint16_t depth;
+    };
+    ReadFieldId intern(const Decl& d);
+
+    std::vector<Decl> m_decls;
+};
+
+// Presents a poll snapshot as a MemorySource: ranges covered by the plan are
+// served from the snapshot, everything else falls through to `fallback`.
+class ReadPlanOverlay final : public MemorySource {
+public:
+    ReadPlanOverlay(const ReadPlanResult& snapshot, MemorySource& fallback)
+        : m_snapshot(snapshot), m_fallback(fallback) {}
+    bool read(uintptr_t address, void* out, size_t size) override;
+    uint32_t hits() const { return m_hits; }
+
+private:
+    const ReadPlanResult& m_snapshot;
+    MemorySource& m_fallback;
+    uint32_t m_hits = 0;
+};
+
+} // namespace efzda
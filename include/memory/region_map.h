@@ -0,0 +1,74 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "memory/memory_source.h"
+
+namespace efzda {
+
+// Cache of readable address ranges in our own process. Lookups are a binary
+// search; the OS is only asked again when an address is not covered yet or
+// the cache has been invalidated (explicitly via invalidate(), or because it
+// is older than maxAge).
+//
+// Backends:
+//  - Windows: VirtualQuery on demand, one region per miss.
+//  - POSIX:   full re-parse of /proc/self/maps on a miss.
+class RegionMap {
+public:
+    struct Region {
+        uintptr_t base = 0;
+        uintptr_t end = 0; // exclusive
+    };
+
+    explicit RegionMap(std::chrono::milliseconds maxAge = std::chrono::milliseconds(1000))
+        : m_maxAge(maxAge) {}
+
+    // True if every byte of [address, address+size) lies in readable memory.
+    // May query the OS (counted in queries()) when the range is not cached.
+    bool covers(uintptr_t address, size_t size);
+
+    // Drop every cached region. Call after a fault or whenever the layout is
+    // known to have changed (module load/unload, session teardown, ...).
+    void invalidate();
+
+    uint32_t generation() const { return m_generation; }
+    uint32_t queries() const { return m_queries; }
+    size_t regionCount() const { return m_regions.size(); }
+    void setMaxAge(std::chrono::milliseconds maxAge) { m_maxAge = maxAge; }
+
+private:
+    bool cachedCovers(uintptr_t address, size_t size) const;
+    // Backend hook: make sure the region containing `address` is cached.
+    // Returns false if it is not readable.
+    bool populate(uintptr_t address);
+    void insert(const Region& r);
+    void expireIfStale();
+
+    std::vector<Region> m_regions; // sorted by base, non-overlapping
+    std::chrono::milliseconds m_maxAge;
+    std::chrono::steady_clock::time_point m_builtAt{};
+    uint32_t m_generation = 0;
+    uint32_t m_queries = 0;
+};
+
+// In-process MemorySource: validates the range against a RegionMap and then
+// copies with memcpy, so a cached hit costs no syscall at all. `syscalls` in
+// the stats counts region queries instead of reads. MinGW builds have no SEH
+// to guard the copy and fall back to ReadProcessMemory.
+class RegionMapMemorySource final : public MemorySource {
+public:
+    explicit RegionMapMemorySource(std::chrono::milliseconds maxAge = std::chrono::milliseconds(1000))
+        : m_map(maxAge) {}
+
+    bool read(uintptr_t address, void* out, size_t size) override;
+
+    RegionMap& regions() { return m_map; }
+
+private:
+    RegionMap m_map;
+};
+
+} // namespace efzda
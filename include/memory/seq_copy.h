@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace efzda {
+
+struct SeqCopyStats {
+    uint64_t copied = 0;    // reads that produced a new consistent copy
+    uint64_t unchanged = 0; // reads skipped because the sequence had not moved
+    uint64_t torn = 0;      // copy attempts rejected as inconsistent
+    uint64_t retries = 0;   // extra attempts after a rejected one
+    uint64_t failed = 0;    // reads that ran out of retries
+};
+
+// Consistent local copy of a block another thread (or module) rewrites in
+// place without a lock, such as the efz_netplay_mod state export. The
+// writer has no begin/end counter, so an attempt is accepted only when the
+// sequence field is the same before, inside and after the copy and two
+// copies taken a short sleep apart are byte-identical. Rejected attempts
+// are retried a bounded number of times; data() keeps the last accepted
+// copy meanwhile.
+// An unchanged sequence costs one 4-byte read and no copy, so callers can
+// keep the parsed result of the last copy instead of parsing again.
+// A writer stalled mid-update across both copies and the sleep still slips
+// through; the next sequence move replaces such a copy. The sleep makes a
+// read that copies cost ~50 us (a timer tick on Windows), so call it from
+// the poll thread, not a hot path.
+class SeqCopyReader {
+public:
+    static constexpr size_t kMaxSize = 4096;
+    static constexpr size_t kNoSeq = static_cast<size_t>(-1);
+
+    enum class Result { Copied, Unchanged, Torn };
+
+    explicit SeqCopyReader(unsigned maxRetries = 4) : m_maxRetries(maxRetries) {}
+
+    // Copy `size` bytes from `live`. `seqOffset` locates a uint32_t sequence
+    // inside the block, or kNoSeq when the layout has none (then every read
+    // copies and only the double-copy check applies). Unchanged means the
+    // sequence still matches the last accepted copy and nothing was copied.
+    Result read(const void* live, size_t size, size_t seqOffset);
+    // Forget the accepted copy, e.g. when the source goes away.
+    void reset();
+
+    // Whether data() holds an accepted copy (of size() bytes).
+    bool valid() const { return m_valid; }
+    const uint8_t* data() const { return m_copy; }
+    size_t size() const { return m_size; }
+    uint32_t seq() const { return m_seq; }
+    const SeqCopyStats& stats() const { return m_stats; }
+
+private:
+    unsigned m_maxRetries;
+    bool m_valid = false;
+    size_t m_size = 0;
+    size_t m_seqOffset = kNoSeq;
+    uint32_t m_seq = 0;
+    SeqCopyStats m_stats;
+    uint8_t m_copy[kMaxSize];    // last accepted copy
+    uint8_t m_attempt[kMaxSize]; // two copies of the current attempt
+    uint8_t m_check[kMaxSize];
+};
+
+} // namespace efzda
@@ -0,0 +1,178 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "memory/memory_source.h"
+
+namespace efzda {
+
+// Poll snapshot files: what GameStateProvider::get() read, poll by poll, so a
+// session can be decoded again offline (see GameStateProvider::replay).
+//
+// Layout (little-endian, every record 8-byte aligned, append-only):
+//
+//   SnapshotFileHeader
+//   SnapshotPollHeader  readCount x SnapshotReadEntry  data  export   (poll 0)
+//   SnapshotPollHeader  ...                                           (poll 1)
+//
+// `data` holds the bytes of every successful read, each at its entry's
+// dataOffset; `export` is the raw netplay export block. Both are padded to 8
+// bytes. A record cut short by a crash ends the file cleanly on load.
+constexpr uint32_t kSnapshotFormatVersion = 1;
+constexpr uint32_t kSnapshotPollMagic = 0x4C4C4F50; // "POLL"
+constexpr uint32_t kSnapshotReadFailed = 0xFFFFFFFFu;
+
+struct SnapshotFileHeader {
+    char magic[8];          // "EFZSNAP\0"
+    uint32_t version;       // kSnapshotFormatVersion
+    uint32_t headerSize;    // sizeof(SnapshotFileHeader)
+    uint32_t pointerSize;   // sizeof(uintptr_t) of the recording process
+    uint32_t reserved[3];
+};
+static_assert(sizeof(SnapshotFileHeader) == 32, "snapshot file header layout");
+
+enum SnapshotExportSource : uint32_t {
+    kSnapshotExportNone = 0,
+    kSnapshotExportSharedMemory = 1,
+    kSnapshotExportDllExport = 2,
+};
+
+struct SnapshotPollHeader {
+    uint32_t magic;            // kSnapshotPollMagic
+    uint32_t recordSize;       // whole record, header included
+    uint32_t poll;
+    uint32_t flags;            // bit 0: efz_netplay_mod loaded
+    uint64_t tick;             // GetTickCount64() at poll start
+    uint64_t efzBase;
+    uint64_t revivalBase;
+    uint32_t revivalVersion;   // EfzRevivalVersion of the recording provider
+    uint32_t revivalTimestamp; // PE TimeDateStamp of EfzRevival.dll
+    uint32_t readCount;
+    uint32_t exportSource;     // SnapshotExportSource
+    uint32_t exportSize;
+    uint32_t dataSize;         // unpadded size of the data area
+};
+static_assert(sizeof(SnapshotPollHeader) == 64, "snapshot poll header layout");
+
+constexpr uint32_t kSnapshotNetplayModLoaded = 1u << 0;
+
+struct SnapshotReadEntry {
+    uint64_t address;
+    uint32_t size;
+    uint32_t dataOffset; // into the data area; kSnapshotReadFailed if the read failed
+};
+static_assert(sizeof(SnapshotReadEntry) == 16, "snapshot read entry layout");
+
+// One poll as seen by the reader. Pointers refer into the reader's buffer.
+struct SnapshotPoll {
+    const SnapshotPollHeader* header = nullptr;
+    const SnapshotReadEntry* reads = nullptr;
+    const uint8_t* data = nullptr;
+    const uint8_t* exportBytes = nullptr; // null when exportSize == 0
+};
+
+// True if the `size` bytes at `bytes` hold the netplay export header (magic,
+// version, structSize) and all structSize bytes it declares, so parsing the
+// block stays inside it.
+bool snapshot_export_complete(const uint8_t* bytes, uint32_t size);
+
+#ifdef _WIN32
+using SnapshotPath = std::wstring;
+#else
+using SnapshotPath = std::string;
+#endif
+
+// Appends polls to a snapshot file. The file header is written when the file
+// is new; an existing file of the same format is extended.
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter() { close(); }
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    bool open(const SnapshotPath& path);
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    // Collect one poll. Reads and the export are only kept between
+    // beginPoll() and endPoll(); endPoll() appends the record and flushes.
+    void beginPoll(const SnapshotPollHeader& header);
+    void addRead(uintptr_t address, const void* data, size_t size, bool ok);
+    void setExport(SnapshotExportSource source, const void* data, size_t size);
+    bool endPoll();
+    bool inPoll() const { return m_inPoll; }
+
+    uint64_t pollsWritten() const { return m_pollsWritten; }
+
+private:
+    std::FILE* m_file = nullptr;
+    bool m_inPoll = false;
+    SnapshotPollHeader m_header{};
+    std::vector<SnapshotReadEntry> m_reads;
+    std::vector<uint8_t> m_data;
+    std::vector<uint8_t> m_export;
+    std::vector<uint8_t> m_record; // reused serialization buffer
+    uint64_t m_pollsWritten = 0;
+};
+
+// Loads a snapshot file and indexes its polls.
+class SnapshotReader {
+public:
+    bool load(const SnapshotPath& path, std::string* error = nullptr);
+    // Same, from an in-memory copy of a file.
+    bool loadBytes(std::vector<uint8_t> bytes, std::string* error = nullptr);
+
+    size_t pollCount() const { return m_polls.size(); }
+    const SnapshotPoll& poll(size_t i) const { return m_polls[i]; }
+    // True if the last record was cut short (the recorder did not finish).
+    bool truncated() const { return m_truncated; }
+    // sizeof(uintptr_t) of the recording process; pointer fields are that wide.
+    uint32_t pointerSize() const { return m_pointerSize; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    std::vector<SnapshotPoll> m_polls;
+    bool m_truncated = false;
+    uint32_t m_pointerSize = 0;
+};
+
+// Decorator that forwards to `inner` and hands every read to the writer while
+// a poll is being recorded.
+class RecordingMemorySource final : public MemorySource {
+public:
+    RecordingMemorySource(MemorySource& inner, SnapshotWriter& writer) : m_inner(inner), m_writer(writer) {}
+
+    bool read(uintptr_t address, void* out, size_t size) override;
+
+private:
+    MemorySource& m_inner;
+    SnapshotWriter& m_writer;
+};
+
+// Serves reads from one recorded poll. Reads normally repeat in recording
+// order, so the next entry is tried first; otherwise any recorded successful
+// read covering the range answers. Anything else fails, like unmapped memory.
+class ReplayMemorySource final : public MemorySource {
+public:
+    void setPoll(const SnapshotPoll* poll) {
+        m_poll = poll;
+        m_cursor = 0;
+    }
+
+    bool read(uintptr_t address, void* out, size_t size) override;
+
+    uint32_t unrecordedReads() const { return m_unrecorded; }
+
+private:
+    bool serve(uint32_t i, uintptr_t address, void* out, size_t size) const;
+
+    const SnapshotPoll* m_poll = nullptr;
+    uint32_t m_cursor = 0;
+    uint32_t m_unrecorded = 0;
+};
+
+} // namespace efzda
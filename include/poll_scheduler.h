@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+
+namespace efzda {
+
+class WaitSource;
+
+struct PollSchedulerConfig {
+    uint32_t fastMs = 100;       // while state is changing
+    uint32_t steadyMs = 500;     // what the interval decays toward (EFZDA_POLL_MS)
+    uint32_t deepMs = 5000;      // game minimized, or nothing changed for deepAfterMs
+    uint32_t holdFastMs = 2000;  // stay at fastMs this long after the last change
+    uint32_t deepAfterMs = 60000;
+    // Notifications closer than this to the previous poll are coalesced
+    // into one poll at the end of the gap.
+    uint32_t notifyMinGapMs = 50;
+};
+
+struct PollSchedulerStats {
+    uint32_t intervalMs = 0;
+    uint32_t wakeupsPerMinute = 0; // over the last full minute
+    uint32_t detections = 0;       // polls that saw a change
+    // Detection latency upper bound: time since the previous poll when a
+    // change is seen (the change happened somewhere in that gap), or since
+    // the notification for a notified poll.
+    uint64_t latencyTotalMs = 0;
+    uint32_t latencyMaxMs = 0;
+    uint32_t notifyWakeups = 0;    // waits ended by the notify source
+};
+
+// What ended PollScheduler::wait().
+enum class PollWake : uint8_t {
+    Timer = 0, // the interval elapsed
+    Wake,      // wake() was called
+    Notify,    // the notify source was signalled
+};
+
+// Drives the worker loop: polls fast while the game state moves, decays
+// toward the steady rate once it stops and drops to a deep-idle rate when
+// the game is minimized or nothing happened for a minute. Waits on a
+// waitable timer plus a wake source instead of sleeping (poll() with a
+// timeout off Windows), and optionally on a notify source another module
+// signals when it has news, so a change shows up without waiting out the
+// interval.
+class PollScheduler {
+public:
+    explicit PollScheduler(const PollSchedulerConfig& cfg = PollSchedulerConfig{});
+    ~PollScheduler();
+    PollScheduler(const PollScheduler&) = delete;
+    PollScheduler& operator=(const PollScheduler&) = delete;
+
+    // Outcome of the poll that just ran; picks the next interval.
+    void onPoll(bool changed, bool gameMinimized);
+    // Blocks until the next poll is due, wake() is called or the notify
+    // source is signalled.
+    PollWake wait();
+    // Cut the current wait short; callable from any thread.
+    void wake();
+    // Source to wait on as well; nullptr for none. The caller keeps it
+    // alive while it is set.
+    void setNotifySource(WaitSource* source) { m_notify = source; }
+
+    uint32_t intervalMs() const { return m_intervalMs; }
+    // At the deep-idle rate (minimized, or nothing changed for deepAfterMs).
+    bool deep() const { return m_intervalMs >= m_cfg.deepMs; }
+    PollSchedulerStats stats() const;
+
+private:
+    PollWake notified();
+
+    PollSchedulerConfig m_cfg;
+    void* m_timer = nullptr; // HANDLE (Windows only)
+    std::unique_ptr<WaitSource> m_wake;
+    WaitSource* m_notify = nullptr; // not owned
+    uint32_t m_intervalMs = 0;
+    uint64_t m_lastPollAt = 0;
+    uint64_t m_notifiedAt = 0; // when the notify source ended the last wait, else 0
+    uint64_t m_lastChangeAt = 0;
+    uint64_t m_windowStart = 0;
+    uint32_t m_windowWakeups = 0;
+    PollSchedulerStats m_stats;
+};
+
+// True when efz.exe's main window is minimized.
+bool game_window_minimized();
+
+} // namespace efzda
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace efzda {
+
+// Every playable EFZ character, keyed by the raw name efz.exe keeps at
+// character+0x94 (at most 12 ASCII bytes, lower-case).
+struct CharacterInfo {
+    const char* raw;           // as read from memory, lower-cased
+    const char* displayName;   // shown in the presence text
+    const char* iconKey;       // Discord small image asset
+    const char* largeImageKey; // Discord large image asset
+    uint8_t netplayCharId;     // efz_netplay_mod p1CharId/p2CharId, 0xFF = not mapped yet
+};
+
+// 1-based index into the registry; 0 = no (or an unrecognised) character.
+using CharacterId = uint8_t;
+constexpr CharacterId kNoCharacter = 0;
+
+// Looks up the raw name bytes as read from memory (stops at the first NUL,
+// ignores control characters, ASCII case-insensitive). One perfect-hash
+// probe and a two-word compare; no allocation.
+CharacterId find_character(const char* raw, size_t size);
+
+// nullptr for kNoCharacter or an out-of-range id.
+const CharacterInfo* character_info(CharacterId id);
+// Empty string for kNoCharacter.
+const char* character_display_name(CharacterId id);
+
+size_t character_count();
+
+} // namespace efzda
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+#include "state/spsc_ring.h"
+
+namespace efzda {
+
+// Edges GameStateProvider::get() observes between two decoded polls. from/to
+// hold the old and new value of whatever changed.
+enum class GameEventType : uint8_t {
+    ScreenChanged,       // EFZ screen index
+    CharacterLocked,     // side's CharacterId (character_registry.h); from = previous id
+    MatchStarted,        // both characters spawned (debounced)
+    MatchEnded,          // characters despawned (debounced)
+    RoundWon,            // side's win count went up
+    SetEnded,            // netplay export setId moved on; from = finished setId
+    NetplayPhaseChanged, // EfzSessionPhase
+    NetplayFlowChanged,  // NetplayFlow (netplay_flow.h), after local overrides
+    SessionEnded,        // EfzEndReason became set; to = reason
+};
+
+struct GameEvent {
+    uint64_t tick = 0;     // poll time (GetTickCount64, or the recorded tick on replay)
+    uint32_t poll = 0;     // GSPoll number
+    GameEventType type = GameEventType::ScreenChanged;
+    int8_t side = -1;      // 0=P1, 1=P2, -1 for events without a side
+    int32_t from = 0;
+    int32_t to = 0;
+};
+
+// Per-subscriber queue; GameStateProvider::get() is the only producer.
+using GameEventQueue = SpscRing<GameEvent, 256>;
+
+const char* game_event_name(GameEventType type);
+
+} // namespace efzda
@@ -1,9 +1,17 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "memory/memory_source.h"
+#include "memory/snapshot_file.h"
+#include "state/game_event.h"
 
 namespace efzda {
 
-struct GameState {
+// Presence text as sent to Discord.
+struct PresenceText {
     std::string details; // e.g., character vs character, score
     std::string state;   // e.g., In Menus, Online, Training
     // Optional Discord assets
@@ -12,18 +20,129 @@ struct GameState {
     // Small image (overlay in a small circle)
     std::string smallImageKey;  // Dev Portal asset key, e.g., "90px-efz_akiko_icon"
     std::string smallImageText; // Tooltip, e.g., opponent character name
-    bool operator==(const GameState &o) const {
+    bool operator==(const PresenceText &o) const {
         return details == o.details && state == o.state &&
                largeImageKey == o.largeImageKey && largeImageText == o.largeImageText &&
                smallImageKey == o.smallImageKey && smallImageText == o.smallImageText;
     }
-    bool operator!=(const GameState &o) const { return !(*this == o); }
+    bool operator!=(const PresenceText &o) const { return !(*this == o); }
+};
+
+// Compact per-poll presence: what the text depends on, as small ids and
+// interned handles, plus a fingerprint of all of it. Only the fields the
+// presence kind renders are set, so equal fingerprints mean equal text.
+// GameStateProvider::materialize() renders it; handles belong to the
+// provider that produced the state.
+struct GameState {
+    uint64_t fingerprint = 0;
+    uint8_t kind = 0;           // presence kind (idle, netplay menu, replay, ...)
+    uint8_t flags = 0;          // kind-specific bits
+    uint8_t gameMode = 0xFF;    // raw EFZ game mode
+    uint8_t screen = 0xFF;      // EFZ screen index
+    int8_t onlineState = 0;
+    uint8_t netplayFlow = 0;
+    uint8_t menuScreen = 0;     // netplay menu screen/detail ids
+    uint8_t menuDetail = 0;
+    uint8_t endReason = 0;
+    int8_t selfIdx = -1;        // 0=P1, 1=P2, -1 unknown
+    int16_t p1Wins = 0;
+    int16_t p2Wins = 0;
+    int32_t sessionMode = 0;
+    int32_t sessionPhase = 0;
+    uint16_t p1Char = 0;        // CharacterId (character_registry.h), 0 = none
+    uint16_t p2Char = 0;
+    uint16_t p1Nick = 0;        // interned nicknames, 0 = empty
+    uint16_t p2Nick = 0;
+    uint16_t localNick = 0;
+    bool operator==(const GameState &o) const { return fingerprint == o.fingerprint; }
+    bool operator!=(const GameState &o) const { return fingerprint != o.fingerprint; }
+};
+
+// Counters of the get() fingerprint short-circuit.
+struct FingerprintStats {
+    uint64_t hits = 0;    // polls answered from the cached GameState
+    uint64_t misses = 0;  // polls that ran a full decode
+    uint64_t expired = 0; // misses caused only by the max-age limit
 };
 
+// Wall time of each get() stage for the most recent poll. Sample covers the
+// module lookup, the read-plan fetch, the export copy and the fingerprint
+// check; a fingerprint hit only fills sampleNs. Format builds the compact
+// GameState; materialize() is not included.
+struct StageTimings {
+    uint64_t sampleNs = 0;
+    uint64_t resolveNs = 0;
+    uint64_t classifyNs = 0;
+    uint64_t formatNs = 0;
+};
+
+// One poll of a replayed snapshot file.
+struct ReplayedPoll {
+    uint32_t poll = 0;   // poll number at recording time
+    uint64_t tick = 0;   // recorded GetTickCount64()
+    GameState state;
+    PresenceText text;
+    bool changed = false; // text differs from the previous poll's
+    StageTimings stages;  // get() stage times for this poll
+};
+
+struct ProviderState;
+class WaitSource;
+
 class GameStateProvider {
 public:
+    GameStateProvider();
+    ~GameStateProvider();
+    GameStateProvider(const GameStateProvider&) = delete;
+    GameStateProvider& operator=(const GameStateProvider&) = delete;
+
+    // Directory of the DLL; efz_offsets.txt is looked up there. Call once
+    // before the first get().
+    void init(const std::wstring& moduleDir);
     // Returns current game state snapshot
     GameState get();
+    // Stops the background key sampler (EFZDA_SAMPLER_HZ) get() started.
+    void shutdown();
+    // The poll loop has dropped to its deep or minimized rate; the key
+    // sampler follows it down to KeySampler::kMaxIntervalMs until cleared.
+    void setPollIdle(bool idle);
+    // Presence strings for a state returned by the latest get() calls; only
+    // needed when an update is actually sent.
+    PresenceText materialize(const GameState& state) const;
+    // Memory read counters (syscalls, bytes) of the most recent get() call.
+    MemoryReadStats lastReadStats() const;
+    FingerprintStats fingerprintStats() const;
+    StageTimings lastStageTimings() const;
+    // True when the most recent get() saw the netplay export appear, go away
+    // or change a session/flow field (the set NPTransition traces). stateSeq
+    // alone does not count: the mod bumps it every frame.
+    bool exportChanged() const;
+    // Append the recent netplay export history (state/netplay_history.h) to
+    // the EFZDA_NETPLAY_HISTORY file now. False when that is unset or the
+    // write fails.
+    bool dumpNetplayHistory(const char* reason = nullptr);
+    // Event efz_netplay_mod signals when its export changes or appears
+    // (EFZ_NETPLAY_STATE_EVENT_NAME), for the poll loop to wait on; nullptr
+    // before init() or when it could not be created. Writers that never
+    // signal it leave polling as the only path.
+    WaitSource* exportNotifySource() const;
+    // Call after a wait ended by that event, before the next get().
+    void exportNotified();
+    // A new event queue for one consumer thread, fed by every later get()
+    // that decodes (a fingerprint hit has nothing new to report). The
+    // provider owns the queue; subscribe before polling starts, not
+    // concurrently with get().
+    GameEventQueue& subscribe();
+    // Events lost because a subscriber's queue was full.
+    uint64_t droppedEvents() const;
+    // Runs get() once per poll recorded with EFZDA_RECORD, serving memory,
+    // module bases and the netplay export from the file, and returns the
+    // resulting presence timeline. Meant for a fresh provider: sticky state
+    // carries over from earlier get() calls.
+    bool replay(const SnapshotPath& path, std::vector<ReplayedPoll>& timeline, std::string* error = nullptr);
+
+private:
+    std::unique_ptr<ProviderState> m_state; // sticky decode state carried across polls
 };
 
 }
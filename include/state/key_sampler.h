@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "memory/region_map.h"
+#include "state/spsc_ring.h"
+
+namespace efzda {
+
+// One frame-rate read of the fields the spawn debounce needs.
+struct KeySample {
+    uint64_t tick = 0;      // ms tick (GetTickCount64() on Windows) at the read
+    uintptr_t p1Ptr = 0;    // character slots, 0 = not spawned
+    uintptr_t p2Ptr = 0;
+    uint8_t screen = 0xFF;  // EFZ screen index
+    bool havePtrs = false;
+    bool haveScreen = false;
+};
+
+// Sized for the slowest poll interval (EFZDA_POLL_MS=5000 at 60 Hz).
+using KeySampleRing = SpscRing<KeySample, 512>;
+
+struct KeySamplerConfig {
+    uintptr_t p1Slot = 0;     // absolute addresses of the key fields
+    uintptr_t p2Slot = 0;
+    uintptr_t screenAddr = 0;
+    uint32_t intervalMs = 16; // ~60 Hz
+    // Average cost allowed per sample. Each 64-sample window above it
+    // doubles the interval, up to kMaxIntervalMs.
+    uint32_t budgetNs = 50000;
+};
+
+struct KeySamplerStats {
+    uint64_t samples = 0;
+    uint64_t dropped = 0;    // ring full: the presence loop fell behind
+    uint64_t totalNs = 0;    // time spent reading, excluding sleeps
+    uint64_t maxNs = 0;
+    uint32_t intervalMs = 0; // current interval after budget backoffs
+    uint32_t backoffs = 0;
+    bool idle = false;       // sampling at kMaxIntervalMs (setIdle)
+};
+
+// Background thread that reads the key fields at game frame rate into a
+// ring the presence loop drains once per poll. Reads go through its own
+// RegionMapMemorySource, so a sample is a region-cache lookup and three
+// memcpys with no syscall.
+class KeySampler {
+public:
+    static constexpr uint32_t kMaxIntervalMs = 250;
+
+    KeySampler() = default;
+    ~KeySampler();
+    KeySampler(const KeySampler&) = delete;
+    KeySampler& operator=(const KeySampler&) = delete;
+
+    bool start(const KeySamplerConfig& cfg);
+    void stop();
+    bool running() const { return m_thread.joinable(); }
+    // While idle the thread samples at kMaxIntervalMs instead of the
+    // configured rate: nothing it reads is expected to move. Any thread.
+    void setIdle(bool idle);
+
+    // Consumer side; only one thread may pop.
+    KeySampleRing& samples() { return m_ring; }
+    KeySamplerStats stats() const;
+
+private:
+    void run();
+
+    KeySamplerConfig m_cfg;
+    RegionMapMemorySource m_memory;
+    KeySampleRing m_ring;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+    std::atomic<uint64_t> m_samples{0};
+    std::atomic<uint64_t> m_totalNs{0};
+    std::atomic<uint64_t> m_maxNs{0};
+    std::atomic<uint32_t> m_intervalMs{0};
+    std::atomic<uint32_t> m_backoffs{0};
+    std::atomic<bool> m_idle{false};
+};
+
+} // namespace efzda
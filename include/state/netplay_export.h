@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "efz_netplay_state.h"
+
+namespace efzda {
+
+constexpr uint32_t EFZ_NETPLAY_STATE_LEGACY_MIN_V1_SIZE = 204u; // pre-lastUpdateTick legacy layout
+
+// Decoded efz_netplay_mod export, independent of the ABI version it came from.
+struct NetplayExportState {
+    bool valid = false;
+    bool fromSharedMemory = false;
+    bool fromDllExport = false;
+    bool hasCapabilityFlags = false;
+    bool hasActivityPhase = false;
+    bool hasEndReason = false;
+    bool hasCharSelectContext = false;
+    bool hasMatchContext = false;
+    uint32_t version = 0;
+    uint32_t structSize = 0;
+    uint32_t lastUpdateTick = 0;
+    uint32_t capabilityFlags = 0;
+    uint32_t stateSeq = 0;
+    uint32_t sessionId = 0;
+    uint32_t setId = 0;
+    int32_t sessionMode = 0;
+    int32_t sessionPhase = 0;
+    int32_t localSide = -1;
+    int32_t p1Wins = 0;
+    int32_t p2Wins = 0;
+    int32_t matchCounter = 0;
+    int32_t pingMs = -1;
+    int32_t rollbackFrames = -1;
+    bool inNetplayMenu = false;
+    uint8_t netplayMenuScreen = 0;
+    uint8_t netplayMenuDetail = EFZ_MENU_DETAIL_NONE;
+    bool inNetplayCharacterSelect = false;
+    bool inNetplayMatch = false;
+    uint8_t activityPhase = EFZ_ACTIVITY_IDLE;
+    uint8_t endReason = EFZ_END_NONE;
+    uint8_t p1CharId = 0xFF;
+    uint8_t p2CharId = 0xFF;
+    bool p1Locked = false;
+    bool p2Locked = false;
+    uint8_t localCursorCharId = 0xFF;
+    uint8_t stageId = 0xFF;
+    uint8_t roundIndex = 0xFF;
+    bool isRoundActive = false;
+    uint16_t roundTimerFrames = 0xFFFF;
+    // Async hosting (v7) — only meaningful when hasAsyncHost is set.
+    bool hasAsyncHost = false;
+    bool asyncHostActive = false;
+    bool asyncHostMinimized = false;
+    bool asyncHostPeerFound = false;
+    bool asyncHostTimedOut = false;
+    uint16_t hostPort = 0;
+    // Extended network metrics (v7) — only meaningful when hasNetDetail is set.
+    bool hasNetDetail = false;
+    int32_t avgPingMs = -1;
+    int32_t minPingMs = -1;
+    int32_t maxPingMs = -1;
+    int32_t recommendedDelay = -1;
+    int32_t minDelay = -1;
+    int32_t maxDelay = -1;
+    // Connection endpoint (v7) — only meaningful when hasConnection is set.
+    bool hasConnection = false;
+    std::string connectionAddress;
+    std::string localNickname;
+    std::string p1Name;
+    std::string p2Name;
+    std::string revivalVersion;
+};
+
+// Decode an export block (header included). The layout is picked from the
+// header's version and structSize through the schema tables in
+// netplay_export.cpp; false when the block is not a recognizable export.
+bool parse_netplay_export_state(const void* block, NetplayExportState& out);
+
+// Offset of stateSeq in the layout parse_netplay_export_state() would use
+// for this header, or false when that layout has none.
+bool netplay_export_seq_offset(uint32_t version, uint32_t structSize, size_t& offset);
+
+} // namespace efzda
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace efzda {
+
+// Where the local player is in the efz_netplay_mod flow, after the local
+// game context has been checked against what the export claims.
+enum class NetplayFlow : uint8_t {
+    None = 0,
+    Menu,
+    Connecting,
+    DelaySetup,
+    CharSelect,
+    Loading,
+    Match,
+    Results,
+    HostIdle,
+};
+constexpr unsigned kNetplayFlowCount = 9;
+
+// Why the resolved flow is what it is. One rule per poll: the last one that
+// changed the export's claim.
+enum class NetplayFlowRule : uint8_t {
+    Claimed = 0,          // export claim kept as-is
+    ExplicitFlags,        // legacy menu flag dropped for char-select/match flags
+    HardOverride,         // menu vs active session + non-title screen or connected VS: local flow
+    HardOverrideLoading,  //   ... nothing local to map, connected: loading
+    HardOverrideDropped,  //   ... nothing local to map
+    LocalContext,         // menu vs gameplay context while connected or export stale: local flow
+    LocalContextLoading,  //   ... nothing local to map, connected: loading
+    LocalContextDropped,  //   ... nothing local to map
+    NotTitle,             // legacy export: menu while the screen is not title
+    ConnectedGameplay,    // legacy export: menu while connected in gameplay context
+    IdleNoFlow,           // session metadata lingers without any flow: inactive
+};
+constexpr unsigned kNetplayFlowRuleCount = 11;
+
+// Title-screen relation of the current EFZ screen index.
+enum class FlowTitleScreen : uint8_t {
+    NoScreen = 0, // screen index unreadable
+    Unknown,      // readable, but no title index configured
+    Title,
+    NotTitle,
+};
+
+// Local screen the flow can be mapped back to. Other when unreadable.
+enum class FlowLocalScreen : uint8_t {
+    Other = 0,
+    CharSelect,
+    Loading,
+    InGame,
+};
+
+// Compact per-poll inputs of the flow resolver; see netplay_flow_key() for
+// the bit layout.
+struct NetplayFlowInputs {
+    NetplayFlow claim = NetplayFlow::None; // what the export says
+    bool claimConflict = false;   // legacy menu flag set alongside char-select/match
+    bool activityPhase = false;   // claim came from the v4+ activity phase
+    bool sessionActive = false;   // export session mode is not NONE
+    bool connected = false;       // session phase CONNECTED
+    bool exportStale = false;     // export sequence stopped advancing
+    bool idleNoFlow = false;
+    FlowTitleScreen titleScreen = FlowTitleScreen::NoScreen;
+    FlowLocalScreen localScreen = FlowLocalScreen::Other;
+    bool live = false;            // both names read or spawn debounced
+    bool vsFlow = false;          // game mode is a VS flow (raw 4/5)
+};
+
+struct NetplayFlowDecision {
+    NetplayFlow flow = NetplayFlow::None;
+    NetplayFlowRule rule = NetplayFlowRule::Claimed;
+};
+
+// 16-bit key:
+//   0-3 claim, 4 claimConflict, 5 activityPhase, 6 sessionActive,
+//   7 connected, 8 exportStale, 9 idleNoFlow, 10-11 titleScreen,
+//   12-13 localScreen, 14 live, 15 vsFlow.
+constexpr unsigned kNetplayFlowKeyCount = 1u << 16;
+uint16_t netplay_flow_key(const NetplayFlowInputs& in);
+NetplayFlowInputs netplay_flow_inputs(uint16_t key);
+
+// O(1): one lookup in the table precomputed from the rules on first use.
+NetplayFlowDecision resolve_netplay_flow(const NetplayFlowInputs& in);
+// The rules themselves, evaluated in order. Used to build the table.
+NetplayFlowDecision evaluate_netplay_flow_rules(const NetplayFlowInputs& in);
+
+const char* netplay_flow_name(NetplayFlow flow);
+const char* netplay_flow_rule_name(NetplayFlowRule rule);
+
+// Writes one CSV row per valid key (claims outside the enum are skipped).
+// Returns the number of rows written.
+size_t write_netplay_flow_table(std::FILE* out);
+
+} // namespace efzda
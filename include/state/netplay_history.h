@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "memory/snapshot_file.h"
+
+namespace efzda {
+
+// Netplay history dumps: the last polls' netplay export state, kept in memory
+// and appended to a file only when something looks wrong (or on request).
+//
+// The provider pushes one record per poll while efz_netplay_mod is loaded.
+// With EFZDA_NETPLAY_HISTORY set it dumps the ring when the export goes
+// stale, a legacy menu flag shows up alongside char select or a match, a
+// HOST/JOIN session lingers with no flow, or a flow claim is dropped with
+// nothing local to map it to; at most once a minute, and never past
+// kMaxFileBytes. That is enough to debug a netplay flow problem with
+// per-poll netplay tracing off.
+//
+// Layout (little-endian, append-only):
+//
+//   NetplayHistoryDumpHeader  count x NetplayHistoryRecord   (dump 0)
+//   NetplayHistoryDumpHeader  ...                            (dump 1)
+//
+// Records are oldest first.
+constexpr uint32_t kNetplayHistoryFormatVersion = 1;
+
+// NetplayHistoryRecord::flags
+constexpr uint16_t kHistoryInMenu = 1u << 0;
+constexpr uint16_t kHistoryInCharSelect = 1u << 1;
+constexpr uint16_t kHistoryInMatch = 1u << 2;
+constexpr uint16_t kHistoryP1Locked = 1u << 3;
+constexpr uint16_t kHistoryP2Locked = 1u << 4;
+constexpr uint16_t kHistoryRoundActive = 1u << 5;
+constexpr uint16_t kHistoryExportStale = 1u << 6;  // stateSeq stuck for > 1.5 s
+constexpr uint16_t kHistoryIdleNoFlow = 1u << 7;   // session set, but idle with no flow
+constexpr uint16_t kHistoryAsyncHost = 1u << 8;    // hasAsyncHost && asyncHostActive
+constexpr uint16_t kHistoryModLoaded = 1u << 9;    // efz_netplay_mod present
+
+// One decoded poll, export fields plus what the provider made of them.
+// Strings are left out on purpose.
+struct NetplayHistoryRecord {
+    uint64_t tick;            // poll time (GetTickCount64)
+    uint32_t poll;
+    uint32_t stateSeq;
+    uint32_t lastUpdateTick;
+    uint32_t capabilityFlags;
+    uint32_t sessionId;
+    uint32_t setId;
+    int32_t sessionMode;
+    int32_t sessionPhase;
+    uint16_t flags;           // kHistory* bits
+    uint16_t roundTimerFrames;
+    int16_t pingMs;
+    int8_t localSide;
+    uint8_t source;           // SnapshotExportSource; kSnapshotExportNone: no export this poll
+    uint8_t version;          // export ABI version (saturated at 255)
+    uint8_t activityPhase;
+    uint8_t endReason;
+    uint8_t menuScreen;
+    uint8_t menuDetail;
+    uint8_t p1CharId;
+    uint8_t p2CharId;
+    uint8_t stageId;
+    uint8_t roundIndex;
+    int8_t p1Wins;
+    int8_t p2Wins;
+    uint8_t flow;             // resolved NetplayFlow
+    uint8_t flowRule;         // NetplayFlowRule that decided it
+    uint8_t screen;           // EFZ screen index, 0xFF unreadable
+    uint8_t gameMode;         // raw EFZ game mode
+    uint8_t reserved;
+};
+static_assert(sizeof(NetplayHistoryRecord) == 64, "netplay history record layout");
+static_assert(std::is_trivially_copyable<NetplayHistoryRecord>::value, "netplay history record must be POD");
+
+struct NetplayHistoryDumpHeader {
+    char magic[8];            // "EFZHIST\0"
+    uint32_t version;         // kNetplayHistoryFormatVersion
+    uint32_t headerSize;      // sizeof(NetplayHistoryDumpHeader)
+    uint32_t recordSize;      // sizeof(NetplayHistoryRecord)
+    uint32_t count;           // records that follow
+    uint64_t tick;            // when the dump was written
+    char reason[32];          // NUL-terminated, e.g. "export-stale"
+};
+static_assert(sizeof(NetplayHistoryDumpHeader) == 64, "netplay history dump header layout");
+
+// Fixed-size ring of the last kCapacity records; push() never allocates.
+class NetplayHistory {
+public:
+    static constexpr size_t kCapacity = 512;
+    // Dumps stop once the file reaches this size.
+    static constexpr long kMaxFileBytes = 4L * 1024 * 1024;
+
+    void push(const NetplayHistoryRecord& record);
+    size_t size() const { return m_count; }
+    // Append one dump of the ring to `path`. False if the file cannot be
+    // written or is already at kMaxFileBytes.
+    bool dump(const SnapshotPath& path, const char* reason, uint64_t tick) const;
+
+private:
+    std::array<NetplayHistoryRecord, kCapacity> m_records{};
+    size_t m_next = 0;
+    size_t m_count = 0;
+};
+
+} // namespace efzda
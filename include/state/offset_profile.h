@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace efzda {
+
+// Memory offsets used by the legacy (1.02e-1.02i style) Revival readers.
+// Resolved once per detected Revival build from three layers, lowest first:
+//   1. built-in defaults compiled into the provider,
+//   2. sections of efz_offsets.txt next to the DLL that match the build,
+//   3. the EFZDA_* offset environment variables.
+// The result is immutable and published through an atomic pointer, so the
+// poll path does a single load instead of env lookups per field.
+struct OffsetProfile {
+    int version = 0;                     // EfzRevivalVersion it was resolved for
+    uintptr_t winsBaseRva = 0;           // 0 = build has no wins/nickname block
+    uintptr_t onlineStateRva = 0;        // direct online-state byte, 0 = none
+    uintptr_t onlineStatePtrRva = 0;
+    uintptr_t onlineStateOffset = 0;
+    uintptr_t onlineStateOffsetAlt = 0;
+    uintptr_t currentPlayerOffset = 0;
+    uintptr_t netP1WinOffset = 0;
+    uintptr_t netP2WinOffset = 0;
+    uintptr_t tournP1WinOffset = 0;
+    uintptr_t tournP2WinOffset = 0;
+    uintptr_t nickP1Offset = 0;
+    uintptr_t nickP2Offset = 0;
+    // Online-state fields differ from the compiled chain tables, so the
+    // runtime chain walk has to be used.
+    bool onlineStateCustom = false;
+    // Layers that contributed, for the startup log.
+    size_t fileValues = 0;
+    size_t envValues = 0;
+};
+
+// Applies the "key = value" lines of the [section] blocks named in
+// `sections` (case-insensitive), one section after another, so later names
+// win. Section names are version tags ("1.02i", "vanilla", ...) or
+// "ts:0x<PE timestamp>" so a new Revival build can be described without
+// recompiling. '#' and ';' start comments.
+// Problems are appended to `warnings`. Returns the number of values applied.
+size_t apply_offsets_text(const std::string& text, const std::vector<std::string>& sections,
+                          OffsetProfile& profile, std::vector<std::string>* warnings = nullptr);
+
+#ifdef _WIN32
+// Reads `path` and applies it like apply_offsets_text(). Missing file = 0.
+size_t apply_offsets_file(const std::wstring& path, const std::vector<std::string>& sections,
+                          OffsetProfile& profile, std::vector<std::string>* warnings = nullptr);
+// Applies the EFZDA_*_RVA / EFZDA_*_OFFSET environment overrides.
+size_t apply_offset_env_overrides(OffsetProfile& profile);
+#endif
+
+} // namespace efzda
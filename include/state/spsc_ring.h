@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace efzda {
+
+// Bounded single-producer/single-consumer queue. One thread calls tryPush(),
+// one other thread calls tryPop(); neither blocks or allocates. A full ring
+// rejects the push, so a slow consumer loses the newest items, never older
+// ones it has not read yet.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    bool tryPush(const T& item) {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[head & kMask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& out) {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) return false;
+        out = m_items[tail & kMask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is active.
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+    static constexpr size_t capacity() { return Capacity; }
+    // Pushes rejected because the ring was full.
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t kMask = static_cast<uint32_t>(Capacity - 1);
+    // Producer and consumer indices on separate cache lines.
+    alignas(64) std::atomic<uint32_t> m_head{0};
+    alignas(64) std::atomic<uint32_t> m_tail{0};
+    alignas(64) std::atomic<uint64_t> m_dropped{0};
+    std::array<T, Capacity> m_items{};
+};
+
+} // namespace efzda
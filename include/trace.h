@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "logger.h"
+
+namespace efzda {
+
+// Tracing front end over log(). Each trace site has a category and a level;
+// a site is emitted only when its category bit is set in the runtime mask
+// and its level is within that category's runtime level. Sites above
+// EFZDA_TRACE_MAX_LEVEL are compiled out entirely. In every disabled case
+// the format arguments (hex dumps, c_str() temporaries, ...) are never
+// evaluated.
+enum class TraceCategory : uint8_t {
+    Memory,  // raw reads, read plans, memory source
+    Session, // game mode, screen, online state, 1.02j session
+    Names,   // character names and nicknames
+    Wins,    // win counters
+    Netplay, // efz_netplay_mod export
+    Poll,    // per-poll decisions in GameStateProvider::get()
+    Count
+};
+
+enum class TraceLevel : uint8_t { Off = 0, Error = 1, Info = 2, Debug = 3, Verbose = 4 };
+
+// Highest level compiled in. Defaults to everything when file logging is
+// built in and to nothing otherwise.
+#ifndef EFZDA_TRACE_MAX_LEVEL
+#if EFZDA_ENABLE_LOGGING
+#define EFZDA_TRACE_MAX_LEVEL 4
+#else
+#define EFZDA_TRACE_MAX_LEVEL 0
+#endif
+#endif
+
+constexpr size_t kTraceCategoryCount = static_cast<size_t>(TraceCategory::Count);
+
+constexpr bool trace_compiled(TraceLevel level) {
+    return static_cast<int>(level) <= EFZDA_TRACE_MAX_LEVEL;
+}
+
+namespace trace_detail {
+extern std::atomic<uint32_t> g_mask; // bit per TraceCategory
+extern std::atomic<uint8_t> g_levels[kTraceCategoryCount];
+} // namespace trace_detail
+
+inline bool trace_enabled(TraceCategory category, TraceLevel level) {
+    const uint32_t bit = 1u << static_cast<unsigned>(category);
+    if (!(trace_detail::g_mask.load(std::memory_order_relaxed) & bit)) return false;
+    return static_cast<uint8_t>(level) <=
+           trace_detail::g_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+}
+
+// Apply EFZDA_TRACE, a comma-separated list of category[:level] entries
+// ("all", "memory", "session", "names", "wins", "netplay", "poll"; levels
+// off/error/info/debug/verbose or 0-4). Unset = every category at verbose.
+void trace_init();
+uint32_t trace_mask();
+void set_trace_mask(uint32_t mask);
+void set_trace_level(TraceCategory category, TraceLevel level);
+const char* trace_category_name(TraceCategory category);
+
+} // namespace efzda
+
+// True when a trace site would be emitted; constant false when compiled out.
+#define EFZDA_TRACE_ON(category, level)                                         \
+    (::efzda::trace_compiled(::efzda::TraceLevel::level) &&                      \
+     ::efzda::trace_enabled(::efzda::TraceCategory::category, ::efzda::TraceLevel::level))
+
+#define EFZDA_TRACE(category, level, ...)                                        \
+    do {                                                                        \
+        if constexpr (::efzda::trace_compiled(::efzda::TraceLevel::level)) {     \
+            if (::efzda::trace_enabled(::efzda::TraceCategory::category,         \
+                                       ::efzda::TraceLevel::level))              \
+                ::efzda::log(__VA_ARGS__);                                      \
+        }                                                                       \
+    } while (0)
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+
+namespace efzda {
+
+// Something one thread (or another module) signals and another blocks on,
+// with auto-reset semantics: a signal stays pending until one wait consumes
+// it, and signals before that collapse into one. PollScheduler waits on the
+// native object together with its own timer and wake source.
+class WaitSource {
+public:
+    virtual ~WaitSource() = default;
+    // False when the OS object could not be created; then signal() does
+    // nothing and wait() only times out.
+    virtual bool isOpen() const = 0;
+    // Wake one waiter (or the next wait). Callable from any thread.
+    virtual void signal() = 0;
+    // Block up to timeoutMs (0: just check) for a signal and consume it.
+    // True when it was signalled.
+    virtual bool wait(uint32_t timeoutMs) = 0;
+    // The object to wait on: the event HANDLE on Windows, a pollable file
+    // descriptor elsewhere. Readiness does not consume the signal; call
+    // wait(0) afterwards.
+    virtual uintptr_t nativeHandle() const = 0;
+};
+
+#ifdef _WIN32
+// Auto-reset Win32 event. With a name, another module can open the same
+// event and signal it (e.g. EFZ_NETPLAY_STATE_EVENT_NAME); the event is
+// created if it does not exist yet, or opened if it does.
+class Win32EventWaitSource final : public WaitSource {
+public:
+    explicit Win32EventWaitSource(const char* name = nullptr);
+    ~Win32EventWaitSource() override;
+    Win32EventWaitSource(const Win32EventWaitSource&) = delete;
+    Win32EventWaitSource& operator=(const Win32EventWaitSource&) = delete;
+    bool isOpen() const override { return m_event != nullptr; }
+    void signal() override;
+    bool wait(uint32_t timeoutMs) override;
+    uintptr_t nativeHandle() const override { return reinterpret_cast<uintptr_t>(m_event); }
+
+private:
+    void* m_event = nullptr; // HANDLE
+};
+#else
+// Linux eventfd in counter mode, drained on wait. Process-local: there are
+// no named events to share with another module off Windows.
+class EventFdWaitSource final : public WaitSource {
+public:
+    EventFdWaitSource();
+    ~EventFdWaitSource() override;
+    EventFdWaitSource(const EventFdWaitSource&) = delete;
+    EventFdWaitSource& operator=(const EventFdWaitSource&) = delete;
+    bool isOpen() const override { return m_fd >= 0; }
+    void signal() override;
+    bool wait(uint32_t timeoutMs) override;
+    uintptr_t nativeHandle() const override { return static_cast<uintptr_t>(m_fd); }
+
+private:
+    int m_fd = -1;
+};
+#endif
+
+} // namespace efzda
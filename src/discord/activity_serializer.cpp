@@ -0,0 +1,167 @@
+#include "discord/activity_serializer.h"
+#include "discord/ipc_frame.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define EFZDA_JSON_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace efzda {
+
+namespace {
+
+// Length of a string literal, for appends of the static fragments.
+template <size_t N>
+constexpr size_t lit(const char (&)[N]) { return N - 1; }
+
+#define EFZDA_APPEND_LIT(out, s) (out).append((s), lit(s))
+
+inline bool needs_escape(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+void append_escape(std::string& out, unsigned char c) {
+    switch (c) {
+        case '"': EFZDA_APPEND_LIT(out, "\\\""); break;
+        case '\\': EFZDA_APPEND_LIT(out, "\\\\"); break;
+        case '\n': EFZDA_APPEND_LIT(out, "\\n"); break;
+        case '\r': EFZDA_APPEND_LIT(out, "\\r"); break;
+        case '\t': EFZDA_APPEND_LIT(out, "\\t"); break;
+        default: {
+            static const char kHex[] = "0123456789abcdef";
+            const char u[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+            out.append(u, sizeof(u));
+        }
+    }
+}
+
+#if EFZDA_JSON_SSE2
+inline unsigned first_bit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+} // namespace
+
+void append_json_escaped(std::string& out, const char* s, size_t n) {
+    size_t i = 0;
+    size_t run = 0; // start of the clean run not yet copied
+#if EFZDA_JSON_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i ctl = _mm_set1_epi8(0x1F);
+    while (n - i >= 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        // c <= 0x1F (unsigned) <=> min(c, 0x1F) == c
+        const __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(v, ctl), v));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask == 0) {
+            i += 16;
+            continue;
+        }
+        do {
+            const size_t at = i + first_bit(mask);
+            out.append(s + run, at - run);
+            append_escape(out, static_cast<unsigned char>(s[at]));
+            run = at + 1;
+            mask &= mask - 1;
+        } while (mask);
+        i += 16;
+    }
+#endif
+    for (; i < n; ++i) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (!needs_escape(c)) continue;
+        out.append(s + run, i - run);
+        append_escape(out, c);
+        run = i + 1;
+    }
+    out.append(s + run, n - run);
+}
+
+ActivitySerializer::ActivitySerializer(uint32_t pid) {
+    m_prefix = "{\"cmd\":\"SET_ACTIVITY\",\"args\":{\"pid\":" + std::to_string(pid) + ",\"activity\":";
+    m_frame.reserve(512);
+}
+
+void ActivitySerializer::appendField(bool& first, const char* key, size_t keyLen, const std::string& value) {
+    if (!first) m_frame += ',';
+    first = false;
+    m_frame.append(key, keyLen);
+    append_json_escaped(m_frame, value.data(), value.size());
+    m_frame += '"';
+}
+
+void ActivitySerializer::appendActivity(const DiscordActivity* activity) {
+    if (!activity) {
+        EFZDA_APPEND_LIT(m_frame, "null");
+        return;
+    }
+    const DiscordActivity& a = *activity;
+    // Note: Include only non-empty fields; some Discord clients ignore updates with empty strings.
+    m_frame += '{';
+    bool first = true;
+    if (!a.details.empty()) appendField(first, "\"details\":\"", lit("\"details\":\""), a.details);
+    if (!a.state.empty()) appendField(first, "\"state\":\"", lit("\"state\":\""), a.state);
+    if (!a.smallImageKey.empty() || !a.largeImageKey.empty()) {
+        if (!first) m_frame += ',';
+        first = false;
+        EFZDA_APPEND_LIT(m_frame, "\"assets\":{");
+        bool firstAsset = true;
+        if (!a.largeImageKey.empty()) {
+            appendField(firstAsset, "\"large_image\":\"", lit("\"large_image\":\""), a.largeImageKey);
+            if (!a.largeImageText.empty())
+                appendField(firstAsset, "\"large_text\":\"", lit("\"large_text\":\""), a.largeImageText);
+        }
+        if (!a.smallImageKey.empty()) {
+            appendField(firstAsset, "\"small_image\":\"", lit("\"small_image\":\""), a.smallImageKey);
+            if (!a.smallImageText.empty())
+                appendField(firstAsset, "\"small_text\":\"", lit("\"small_text\":\""), a.smallImageText);
+        }
+        m_frame += '}';
+    }
+    // Optional: mark as instance (not strictly required but harmless)
+    if (!first) m_frame += ',';
+    EFZDA_APPEND_LIT(m_frame, "\"instance\":true}");
+}
+
+const std::string& ActivitySerializer::setActivity(const DiscordActivity* activity, const char* nonce) {
+    m_frame.assign(8, '\0'); // header, patched below
+    m_frame += m_prefix;
+    appendActivity(activity);
+    // Same bytes as the old hand-built frames, stray space included.
+    if (activity) EFZDA_APPEND_LIT(m_frame, "} ,\"nonce\":\"");
+    else EFZDA_APPEND_LIT(m_frame, "},\"nonce\":\"");
+    m_frame += nonce;
+    EFZDA_APPEND_LIT(m_frame, "\"}");
+    const uint32_t hdr[2] = { kIpcFrame, static_cast<uint32_t>(m_frame.size() - 8) };
+    std::memcpy(&m_frame[0], hdr, sizeof(hdr));
+    return m_frame;
+}
+
+uint64_t ActivitySerializer::activityHash(const DiscordActivity* activity) {
+    m_frame.clear();
+    appendActivity(activity);
+    // FNV-1a
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (const char c : m_frame) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+} // namespace efzda
@@ -1,18 +1,52 @@
-// Discord Rich Presence via native IPC (named pipe) compatible with newer Discord clients
+// Discord Rich Presence via native IPC (named pipe or Unix socket) compatible with newer Discord clients
 #include "discord/discord_client.h"
+#include "discord/activity_serializer.h"
+#include "discord/ipc_frame.h"
+#include "discord/ipc_nonce.h"
+#include "discord/ipc_transport.h"
+#include "discord/rate_limiter.h"
 #include "logger.h"
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <algorithm>
-#include <objbase.h>
-#include <rpc.h>
-#pragma comment(lib, "Rpcrt4.lib")
+#include <chrono>
 
 namespace efzda {
 
-static HANDLE g_pipe = INVALID_HANDLE_VALUE;
+static std::unique_ptr<IpcTransport> g_transport;
 static std::string g_appId;
+
+static uint64_t now_ms() {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+static void sleep_ms(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static uint32_t current_pid() {
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+#ifdef _WIN32
 static bool g_isWine = false;
 static bool detect_wine_once() {
     static bool inited = false;
@@ -34,110 +68,479 @@ static bool detect_wine_once() {
     }
     return underWine;
 }
+#endif
 
-static std::string escape_json(const std::string& in) {
-    std::string out; out.reserve(in.size() + 8);
-    for (char c : in) {
-        switch (c) {
-            case '"': out += "\\\""; break;
-            case '\\': out += "\\\\"; break;
-            case '\n': out += "\\n"; break;
-            case '\r': out += "\\r"; break;
-            case '\t': out += "\\t"; break;
-            default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    char buf[7];
-                    std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
-                    out += buf;
-                } else {
-                    out += c;
-                }
+static bool write_frame(uint32_t op, const std::string& json) {
+    if (!g_transport || !g_transport->isOpen()) return false;
+    const std::string frame = encode_ipc_frame(op, json);
+    return g_transport->write(frame.data(), frame.size());
+}
+
+static void close_transport() {
+    if (g_transport) g_transport->close();
+    g_transport.reset();
+}
+
+// Try `t` `attempts` times, `delayMs` apart; keep it as the active transport on success.
+static bool try_transport(std::unique_ptr<IpcTransport> t, int attempts, uint32_t delayMs) {
+    for (int i = 0; i < attempts; ++i) {
+        if (i > 0) sleep_ms(delayMs);
+        if (t->connect()) {
+            log("Discord IPC: Connected via %s", t->name());
+            g_transport = std::move(t);
+            return true;
         }
     }
-    return out;
+    return false;
 }
 
-static bool write_frame(uint32_t op, const std::string& json) {
-    if (g_pipe == INVALID_HANDLE_VALUE) return false;
-    struct Header { uint32_t op; uint32_t len; } hdr{ op, static_cast<uint32_t>(json.size()) };
-    DWORD written = 0;
-    if (!WriteFile(g_pipe, &hdr, sizeof(hdr), &written, nullptr) || written != sizeof(hdr))
-        return false;
-    if (!WriteFile(g_pipe, json.data(), (DWORD)json.size(), &written, nullptr) || written != json.size())
-        return false;
-    return true;
+#ifdef _WIN32
+// EFZDA_IPC_TRANSPORT=pipe|socket limits connect() to one backend; default tries both.
+static int transport_override() {
+    wchar_t buf[16];
+    DWORD n = GetEnvironmentVariableW(L"EFZDA_IPC_TRANSPORT", buf, _countof(buf));
+    if (n == 0 || n >= _countof(buf)) return 0;
+    if (_wcsicmp(buf, L"pipe") == 0) return 1;
+    if (_wcsicmp(buf, L"socket") == 0) return 2;
+    return 0;
 }
 
 static bool connect_pipe() {
+    static bool s_bridgeLaunched = false;
+    close_transport();
     g_isWine = detect_wine_once();
-    auto try_connect = []() -> bool {
-        for (int i = 0; i < 10; ++i) {
-            wchar_t name[64];
-            swprintf_s(name, L"\\\\.\\pipe\\discord-ipc-%d", i);
-            HANDLE h = CreateFileW(name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-            if (h != INVALID_HANDLE_VALUE) {
-                g_pipe = h;
-                return true;
-            }
-        }
-        return false;
-    };
+    const int only = transport_override();
     // Strategy:
-    // - On native Windows: only try named pipes; do NOT attempt bridge (faster failure on no Discord).
-    // - On Wine/Proton: try bridge first (if configured) to speed up startup, then connect.
+    // - On native Windows: named pipes with a short retry (Discord's pipe may not be up yet).
+    // - On Wine/Proton: the Linux client's Unix socket directly, then named pipes
+    //   (a bridge may already be running), and only then spawn EFZDA_WINE_BRIDGE.
     if (!g_isWine) {
-        // Native Windows: retry briefly in case Discord's pipe isn't ready yet
-        for (int attempt = 0; attempt < 10; ++attempt) {
-            if (try_connect()) return true;
-            Sleep(100);
-        }
-        return false;
+        // The Windows client has no Unix socket; only try one when asked to.
+        if (only == 2) return try_transport(std::make_unique<UnixSocketTransport>(), 1, 0);
+        return try_transport(std::make_unique<NamedPipeTransport>(), 10, 100);
     }
 
-    // Under Wine/Proton: spawn bridge first if provided
+    if (only != 1 && try_transport(std::make_unique<UnixSocketTransport>(), 1, 0)) return true;
+    if (only == 2) return false;
+    if (try_transport(std::make_unique<NamedPipeTransport>(), 1, 0)) return true;
+
+    // Fallback: spawn the bridge if provided
     wchar_t bridgePath[512];
     DWORD n = GetEnvironmentVariableW(L"EFZDA_WINE_BRIDGE", bridgePath, _countof(bridgePath));
-    if (n > 0 && n < _countof(bridgePath)) {
+    // Once per process; later reconnects find its pipe in the attempt above.
+    if (!s_bridgeLaunched && n > 0 && n < _countof(bridgePath)) {
         STARTUPINFOW si{}; si.cb = sizeof(si);
         PROCESS_INFORMATION pi{};
         // CreateProcessW modifies the buffer, so copy to a writable command line
         std::wstring cmd = L"\"" + std::wstring(bridgePath) + L"\"";
         BOOL ok = CreateProcessW(nullptr, cmd.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi);
         if (ok) {
+            s_bridgeLaunched = true;
             log("Discord IPC: Launched Wine bridge: '%ls'", bridgePath);
             CloseHandle(pi.hThread);
-            // Give it a moment to create the named pipe
-            Sleep(500);
-            // Retry connect a couple of times
-            for (int i = 0; i < 5; ++i) {
-                if (try_connect()) return true;
-                Sleep(300);
-            }
             CloseHandle(pi.hProcess);
+            // Give it a moment to create the named pipe
+            sleep_ms(500);
+            if (try_transport(std::make_unique<NamedPipeTransport>(), 5, 300)) return true;
         } else {
             log("Discord IPC: Failed to launch Wine bridge: '%ls' (err=%lu)", bridgePath, GetLastError());
         }
     }
-    // Final attempt: try connecting anyway (bridge might already be running)
-    return try_connect();
+    return false;
+}
+#else
+// Off Windows (tests) the Unix socket is the only way to the client.
+static bool connect_pipe() {
+    close_transport();
+    return try_transport(std::make_unique<UnixSocketTransport>(), 1, 0);
+}
+#endif
+
+static std::string handshake_json() {
+    return std::string("{\"v\": 1, \"client_id\": \"") + g_appId + "\"}";
+}
+
+// Single-slot, latest-wins mailbox between the poll thread and the writer.
+// A clear followed by an update that the writer has not picked up yet
+// becomes one item that clears first.
+struct PresenceMail {
+    bool pending = false;
+    bool clear = false;      // SET_ACTIVITY null instead of `presence`
+    bool clearFirst = false; // send a clear, then `presence`
+    bool force = false;      // resend even if Discord already shows it
+    uint32_t rejects = 0;    // times Discord answered it with ERROR
+    DiscordActivity presence;
+};
+
+static std::mutex g_mailMutex;
+static std::condition_variable g_mailCv;
+static PresenceMail g_mail;
+static uint32_t g_mailSeq = 0; // bumped by every publish
+static bool g_stop = false;
+static std::thread g_writer;
+// Writer counters and SET_ACTIVITY budget; both under g_mailMutex.
+static DiscordClientStats g_stats;
+static ActivityRateLimiter g_limiter;
+
+static void publish(PresenceMail mail) {
+    {
+        std::lock_guard<std::mutex> lock(g_mailMutex);
+        if (g_mail.pending) {
+            ++g_stats.coalesced;
+            if (!mail.clear && (g_mail.clear || g_mail.clearFirst)) mail.clearFirst = true;
+            if (g_mail.force) mail.force = true;
+        }
+        mail.pending = true;
+        g_mail = std::move(mail);
+        ++g_mailSeq;
+    }
+    g_mailCv.notify_one();
+}
+
+// Discord answers the handshake with a READY dispatch and every command
+// with a reply carrying its nonce. Bridges that do not relay replies get
+// kReadyTimeoutMs to prove otherwise; after that the session runs
+// fire-and-forget, as before replies were read.
+constexpr uint32_t kReadyTimeoutMs = 3000;
+constexpr uint32_t kAckTimeoutMs = 5000;   // no reply by then: lost, reconnect and resend
+constexpr uint32_t kBusyReadMs = 20;       // read interval while a reply is due
+constexpr uint32_t kIdleReadMs = 500;      // read interval otherwise (PING/CLOSE)
+constexpr uint32_t kMaxRejects = 3;        // resends of an update Discord answered with ERROR
+
+enum class SessionState : uint8_t { Closed, AwaitReady, Ready };
+
+// Writer thread only.
+struct WriterSession {
+    SessionState state = SessionState::Closed;
+    uint64_t readyDeadline = 0;
+    bool hearsReplies = false; // any frame seen; replies are only awaited then
+    IpcFrameDecoder decoder;
+    // The SET_ACTIVITY whose reply is due.
+    bool awaitingAck = false;
+    uint32_t ackSeq = 0;
+    PresenceMail ackMail;
+    uint64_t ackHash = 0;
+    uint64_t sentAt = 0;
+    // Last activity Discord has (acked, or written when replies are not
+    // heard); a new connection starts with none.
+    bool hasDelivered = false;
+    uint64_t deliveredHash = 0;
+};
+static WriterSession g_session;
+// Writer thread only. Built on first use: seeding it may load the OS RNG,
+// which must not happen during DLL attach.
+static NonceGenerator& nonces() {
+    static NonceGenerator s_nonces;
+    return s_nonces;
+}
+
+// Writer thread only; built on first use, like nonces().
+static ActivitySerializer& serializer() {
+    static ActivitySerializer s_serializer(current_pid());
+    return s_serializer;
+}
+
+static uint64_t payload_hash(const PresenceMail& mail) {
+    return serializer().activityHash(mail.clear ? nullptr : &mail.presence);
+}
+
+struct PumpResult {
+    bool acked = false;
+    bool rejected = false;
+    bool closed = false; // connection is gone or unusable
+};
+
+static bool open_session(uint64_t now) {
+    if (!connect_pipe()) return false;
+    // Handshake (OP 0)
+    if (!write_frame(kIpcHandshake, handshake_json())) {
+        log("Discord IPC: Handshake write failed.");
+        close_transport();
+        return false;
+    }
+    g_session.state = SessionState::AwaitReady;
+    g_session.readyDeadline = now + kReadyTimeoutMs;
+    g_session.hearsReplies = false;
+    g_session.decoder.reset();
+    g_session.awaitingAck = false;
+    g_session.hasDelivered = false;
+    return true;
+}
+
+static void drop_session() {
+    close_transport();
+    g_session.state = SessionState::Closed;
+    g_session.awaitingAck = false;
+    g_session.hasDelivered = false; // Discord drops our activity with the connection
+}
+
+static void mark_delivered(uint64_t hash) {
+    g_session.hasDelivered = true;
+    g_session.deliveredHash = hash;
+}
+
+static void handle_frame(const IpcFrame& frame, PumpResult& r) {
+    g_session.hearsReplies = true;
+    switch (frame.op) {
+        case kIpcPing:
+            if (!write_frame(kIpcPong, frame.json)) r.closed = true;
+            return;
+        case kIpcClose:
+            log("Discord IPC: Closed by Discord: %.200s", frame.json.c_str());
+            r.closed = true;
+            return;
+        case kIpcFrame:
+            break;
+        default:
+            return;
+    }
+    std::string cmd, evt, nonce;
+    json_top_level_string(frame.json, "cmd", cmd);
+    json_top_level_string(frame.json, "evt", evt);
+    const bool hasNonce = json_top_level_string(frame.json, "nonce", nonce);
+    uint32_t seq = 0;
+    const bool ours = hasNonce && nonces().sequenceOf(nonce, seq);
+    if (cmd == "DISPATCH" && evt == "READY") {
+        if (g_session.state == SessionState::AwaitReady) log("Discord IPC: READY");
+        g_session.state = SessionState::Ready;
+    } else if (g_session.awaitingAck && ours && seq == g_session.ackSeq) {
+        g_session.awaitingAck = false;
+        if (evt == "ERROR") {
+            log("Discord IPC: SET_ACTIVITY rejected: %.200s", frame.json.c_str());
+            r.rejected = true;
+        } else {
+            r.acked = true;
+        }
+    } else if (evt == "ERROR" && !hasNonce) {
+        // Not tied to a command, e.g. a bad client id; Discord closes next.
+        log("Discord IPC: Error from Discord: %.200s", frame.json.c_str());
+        r.closed = true;
+    }
 }
 
-static std::string new_nonce() {
-    UUID uuid{};
-    if (UuidCreate(&uuid) != RPC_S_OK && UuidCreateSequential(&uuid) != RPC_S_OK) {
-        // Fallback: timestamp-based
-        return std::to_string(GetTickCount64());
+// Read and handle whatever Discord sent since the last call.
+static PumpResult pump_session() {
+    PumpResult r;
+    char buf[4096];
+    long n;
+    while ((n = g_transport->read(buf, sizeof(buf))) > 0) g_session.decoder.feed(buf, static_cast<size_t>(n));
+    if (n < 0) r.closed = true;
+    IpcFrame frame;
+    while (!r.closed && g_session.decoder.next(frame)) handle_frame(frame, r);
+    if (g_session.decoder.failed()) {
+        log("Discord IPC: Malformed frame from Discord; reconnecting");
+        r.closed = true;
+    }
+    return r;
+}
+
+// Writer thread only. `seq` gets the nonce sequence number of the last
+// command written.
+static bool deliver(const PresenceMail& mail, uint32_t& seq) {
+    ActivitySerializer& ser = serializer();
+    auto send = [](const std::string& frame) {
+        return g_transport && g_transport->write(frame.data(), frame.size());
+    };
+    char nonce[NonceGenerator::kMaxLen];
+    if (mail.clear) {
+        seq = nonces().next(nonce);
+        return send(ser.setActivity(nullptr, nonce));
     }
-    RPC_CSTR sz = nullptr;
-    if (UuidToStringA(&uuid, &sz) == RPC_S_OK && sz) {
-        std::string s(reinterpret_cast<char*>(sz));
-        RpcStringFreeA(&sz);
-        // remove braces if present
-        s.erase(std::remove(s.begin(), s.end(), '{'), s.end());
-        s.erase(std::remove(s.begin(), s.end(), '}'), s.end());
-        return s;
+    if (mail.clearFirst) {
+        nonces().next(nonce);
+        if (!send(ser.setActivity(nullptr, nonce))) return false;
+        // Tiny delay to let Discord register the clear
+        sleep_ms(50);
     }
-    return std::to_string(GetTickCount64());
+    const DiscordActivity& p = mail.presence;
+    // Log a succinct summary for troubleshooting
+    log("Discord IPC: Update(details='%s', state='%s', large='%s', small='%s')",
+        p.details.c_str(), p.state.c_str(), p.largeImageKey.c_str(), p.smallImageKey.c_str());
+    seq = nonces().next(nonce);
+    return send(ser.setActivity(&p, nonce));
+}
+
+// Owns the transport. Connects, waits for READY, sends whatever is in the
+// mailbox one command at a time and waits for its reply. An item goes out
+// again only when it was lost (write failed, connection dropped, no reply)
+// or rejected, and only if nothing newer replaced it meanwhile. While
+// Discord is unreachable it retries with backoff (1 s, doubling up to 30 s).
+// Runs on its own thread, so a slow or missing Discord never holds up the
+// poll loop, which only ever touches the mailbox.
+// Each SET_ACTIVITY spends a g_limiter token (Discord allows 5 per 20 s);
+// without one the item waits in the mailbox, and whatever is newest when a
+// token frees up is what goes out.
+// An item whose activity hash matches what Discord already shows is
+// dropped before it spends a token, unless it is a forced resend.
+static void writer_main() {
+    if (!open_session(now_ms()))
+        log("Discord IPC: Could not connect to Discord (named pipe or Unix socket); retrying in the background.");
+    else
+        log("Discord IPC: Initialized (AppID=%s)", g_appId.c_str());
+
+    std::unique_lock<std::mutex> lock(g_mailMutex);
+    PresenceMail retry;
+    uint32_t backoffMs = 0;
+    uint64_t retryAt = 0;
+    bool waitedForToken = false;
+    uint32_t seenSeq = g_mailSeq;
+    auto back_off = [&](uint64_t now) {
+        backoffMs = backoffMs == 0 ? 1000 : (std::min)(backoffMs * 2, 30000u);
+        retryAt = now + backoffMs;
+    };
+    // Resend `mail` unless something newer is queued.
+    auto requeue = [&](PresenceMail&& mail) {
+        if (!g_mail.pending && !retry.pending) retry = std::move(mail);
+    };
+
+    for (;;) {
+        const bool stopping = g_stop;
+        lock.unlock();
+        uint64_t now = now_ms();
+        PumpResult r;
+        bool lost = false;
+        if (g_session.state != SessionState::Closed) {
+            r = pump_session();
+            if (!r.closed && g_session.state == SessionState::AwaitReady && now >= g_session.readyDeadline) {
+                log("Discord IPC: No READY after %u ms; sending without waiting for replies", kReadyTimeoutMs);
+                g_session.state = SessionState::Ready;
+            }
+            if (!r.closed && g_session.awaitingAck && now - g_session.sentAt >= kAckTimeoutMs) {
+                log("Discord IPC: No reply to SET_ACTIVITY after %u ms; reconnecting", kAckTimeoutMs);
+                lost = true;
+                r.closed = true;
+            }
+        }
+        PresenceMail unacked;
+        // Dropped before READY: the handshake was refused (e.g. bad App ID).
+        const bool refused = r.closed && g_session.state == SessionState::AwaitReady;
+        if (r.closed) {
+            if (g_session.awaitingAck) {
+                unacked = std::move(g_session.ackMail);
+                lost = true;
+            }
+            drop_session();
+        }
+        lock.lock();
+
+        if (refused) back_off(now);
+        if (r.acked) {
+            ++g_stats.acked;
+            mark_delivered(g_session.ackHash);
+        }
+        if (r.rejected) {
+            ++g_stats.rejected;
+            PresenceMail& mail = g_session.ackMail;
+            if (++mail.rejects < kMaxRejects) {
+                requeue(std::move(mail));
+                back_off(now);
+            }
+        }
+        if (lost) {
+            ++g_stats.lost;
+            if (unacked.pending) requeue(std::move(unacked));
+        }
+
+        if (stopping) {
+            // Flush the newest item over a live connection without waiting
+            // for READY or replies; never connect just to clear.
+            PresenceMail& last = g_mail.pending ? g_mail : retry;
+            if (last.pending && !last.force && g_session.hasDelivered && payload_hash(last) == g_session.deliveredHash) {
+                ++g_stats.suppressed;
+            } else if (last.pending && g_session.state != SessionState::Closed) {
+                PresenceMail mail = std::move(last);
+                lock.unlock();
+                uint32_t seq = 0;
+                const bool ok = deliver(mail, seq);
+                lock.lock();
+                if (ok) ++g_stats.sent;
+                else ++g_stats.failed;
+            }
+            break;
+        }
+
+        const bool busy = g_session.state == SessionState::AwaitReady || g_session.awaitingAck;
+        uint64_t waitMs = g_session.state == SessionState::Closed ? 0 : (busy ? kBusyReadMs : kIdleReadMs);
+        const PresenceMail& next = g_mail.pending ? g_mail : retry;
+        if (next.pending) {
+            if (backoffMs > 0 && now < retryAt) {
+                waitMs = waitMs ? (std::min<uint64_t>)(waitMs, retryAt - now) : retryAt - now;
+            } else if (g_session.state == SessionState::Closed) {
+                lock.unlock();
+                const bool ok = open_session(now);
+                lock.lock();
+                if (ok) backoffMs = 0;
+                else { ++g_stats.failed; back_off(now); }
+                continue;
+            } else if (!busy) {
+                // Discord already shows exactly this payload: drop it unless
+                // it is a forced resend. No token is spent on it.
+                const uint64_t hash = payload_hash(next);
+                if (!next.force && g_session.hasDelivered && hash == g_session.deliveredHash) {
+                    ++g_stats.suppressed;
+                    if (g_mail.pending && retry.pending) ++g_stats.coalesced;
+                    g_mail = PresenceMail{};
+                    retry = PresenceMail{};
+                    waitedForToken = false;
+                    continue;
+                }
+                // Out of SET_ACTIVITY budget: wait for a token with the item
+                // still in the mailbox, so whatever is newest when the token
+                // frees up is sent and everything in between is coalesced away.
+                const uint32_t cost = next.clearFirst ? 2 : 1;
+                const uint64_t tokenMs = g_limiter.waitMs(now, cost);
+                if (tokenMs > 0) {
+                    if (!waitedForToken) ++g_stats.deferred;
+                    waitedForToken = true;
+                    waitMs = (std::min)(waitMs, tokenMs);
+                } else {
+                    PresenceMail mail;
+                    if (g_mail.pending) {
+                        if (retry.pending) ++g_stats.coalesced;
+                        mail = std::move(g_mail);
+                        g_mail = PresenceMail{};
+                    } else {
+                        mail = std::move(retry);
+                    }
+                    retry = PresenceMail{};
+                    waitedForToken = false;
+                    g_limiter.take(now, cost);
+                    lock.unlock();
+                    uint32_t seq = 0;
+                    const bool ok = deliver(mail, seq);
+                    if (ok && g_session.hearsReplies) {
+                        g_session.awaitingAck = true;
+                        g_session.ackSeq = seq;
+                        g_session.ackMail = mail;
+                        g_session.ackHash = hash;
+                        g_session.sentAt = now_ms();
+                    } else if (ok) {
+                        mark_delivered(hash);
+                    }
+                    if (!ok) drop_session();
+                    lock.lock();
+                    if (ok) {
+                        ++g_stats.sent;
+                        backoffMs = 0;
+                    } else {
+                        ++g_stats.failed;
+                        requeue(std::move(mail));
+                        back_off(now);
+                    }
+                    continue;
+                }
+            }
+        }
+        auto woken = [&] { return g_stop || g_mailSeq != seenSeq; };
+        if (waitMs == 0) g_mailCv.wait(lock, woken);
+        else g_mailCv.wait_for(lock, std::chrono::milliseconds(waitMs), woken);
+        seenSeq = g_mailSeq;
+    }
+    log("Discord IPC: writer stopped (sent=%u acked=%u rejected=%u lost=%u coalesced=%u deferred=%u suppressed=%u failed=%u)",
+        g_stats.sent, g_stats.acked, g_stats.rejected, g_stats.lost, g_stats.coalesced, g_stats.deferred,
+        g_stats.suppressed, g_stats.failed);
+    lock.unlock();
+    drop_session();
 }
 
 bool DiscordClient::init(const std::string &appId) {
@@ -145,18 +548,15 @@ bool DiscordClient::init(const std::string &appId) {
         log("Discord IPC: No App ID; Rich Presence disabled.");
         return false;
     }
+    if (g_writer.joinable()) return true;
     g_appId = appId;
-    if (!connect_pipe()) {
-        log("Discord IPC: Could not connect to Discord named pipe.");
+    g_stop = false;
+    try {
+        g_writer = std::thread(writer_main);
+    } catch (...) {
+        log("Discord IPC: Failed to start writer thread; Rich Presence disabled.");
         return false;
     }
-    // Handshake (OP 0)
-    std::string hs = std::string("{\"v\": 1, \"client_id\": \"") + g_appId + "\"}";
-    if (!write_frame(0, hs)) {
-        log("Discord IPC: Handshake write failed.");
-        CloseHandle(g_pipe); g_pipe = INVALID_HANDLE_VALUE; return false;
-    }
-    log("Discord IPC: Initialized (AppID=%s)", g_appId.c_str());
     return true;
 }
 
@@ -164,78 +564,39 @@ void DiscordClient::updatePresence(const std::string &details, const std::string
                                    const std::string &smallImageKey,
                                    const std::string &smallImageText,
                                    const std::string &largeImageKey,
-                                   const std::string &largeImageText) {
-    if (g_pipe == INVALID_HANDLE_VALUE) return;
-    std::string nonce = new_nonce();
-    // Note: Include only non-empty fields; some Discord clients ignore updates with empty strings.
-    std::string activity = "{";
-    bool needComma = false;
-    if (!details.empty()) {
-        activity += "\"details\":\"" + escape_json(details) + "\"";
-        needComma = true;
-    }
-    if (!state.empty()) {
-        if (needComma) activity += ",";
-        activity += "\"state\":\"" + escape_json(state) + "\"";
-        needComma = true;
-    }
-    // assets
-    if (!smallImageKey.empty() || !largeImageKey.empty()) {
-        if (needComma) activity += ",";
-        activity += "\"assets\":{";
-        bool first = true;
-        if (!largeImageKey.empty()) {
-            activity += "\"large_image\":\"" + escape_json(largeImageKey) + "\"";
-            if (!largeImageText.empty()) activity += ",\"large_text\":\"" + escape_json(largeImageText) + "\"";
-            first = false;
-        }
-        if (!smallImageKey.empty()) {
-            if (!first) activity += ",";
-            activity += "\"small_image\":\"" + escape_json(smallImageKey) + "\"";
-            if (!smallImageText.empty()) activity += ",\"small_text\":\"" + escape_json(smallImageText) + "\"";
-        }
-        activity += "}";
-        needComma = true;
-    }
-    // Optional: mark as instance (not strictly required but harmless)
-    if (needComma) activity += ",";
-    activity += "\"instance\":true";
-    activity += "}"; // close activity
-    // Log a succinct summary for troubleshooting
-    log("Discord IPC: Update(details='%s', state='%s', large='%s', small='%s')",
-        details.c_str(), state.c_str(), largeImageKey.c_str(), smallImageKey.c_str());
-    std::string json = std::string("{\"cmd\":\"SET_ACTIVITY\",\"args\":{\"pid\":")
-        + std::to_string(GetCurrentProcessId()) + ",\"activity\":" + activity +
-        "} ,\"nonce\":\"" + nonce + "\"}";
-    if (!write_frame(1, json)) {
-        log("Discord IPC: SET_ACTIVITY write failed; attempting reconnect");
-        if (g_pipe != INVALID_HANDLE_VALUE) { CloseHandle(g_pipe); g_pipe = INVALID_HANDLE_VALUE; }
-        if (connect_pipe()) {
-            // Try once more with the same payload after a successful reconnect
-            if (!write_frame(1, json)) {
-                log("Discord IPC: SET_ACTIVITY write failed after reconnect");
-            }
-        }
-    }
+                                   const std::string &largeImageText,
+                                   bool force) {
+    if (!g_writer.joinable()) return;
+    PresenceMail mail;
+    mail.force = force;
+    mail.presence = DiscordActivity{details, state, smallImageKey, smallImageText, largeImageKey, largeImageText};
+    publish(std::move(mail));
 }
 
 void DiscordClient::poll() {
-    // Optional: could read responses; we keep it as a no-op
+    // Replies (READY, acks, PING) are read on the writer thread.
 }
 
 void DiscordClient::clearPresence() {
-    if (g_pipe == INVALID_HANDLE_VALUE) return;
-    std::string nonce = new_nonce();
-    std::string json = std::string("{\"cmd\":\"SET_ACTIVITY\",\"args\":{\"pid\":")
-        + std::to_string(GetCurrentProcessId()) + ",\"activity\":null},\"nonce\":\"" + nonce + "\"}";
-    write_frame(1, json);
+    if (!g_writer.joinable()) return;
+    PresenceMail mail;
+    mail.clear = true;
+    publish(std::move(mail));
+}
+
+DiscordClientStats DiscordClient::stats() const {
+    std::lock_guard<std::mutex> lock(g_mailMutex);
+    return g_stats;
 }
 
 void DiscordClient::shutdown() {
-    if (g_pipe != INVALID_HANDLE_VALUE) {
-        CloseHandle(g_pipe);
-        g_pipe = INVALID_HANDLE_VALUE;
+    if (!g_writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(g_mailMutex);
+        g_stop = true;
     }
+    g_mailCv.notify_one();
+    g_writer.join();
 }
 
 } // namespace efzda
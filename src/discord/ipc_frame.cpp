@@ -0,0 +1,140 @@
+#include "discord/ipc_frame.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace efzda {
+
+std::string encode_ipc_frame(uint32_t op, const std::string& json) {
+    const uint32_t hdr[2] = { op, static_cast<uint32_t>(json.size()) };
+    std::string frame(sizeof(hdr) + json.size(), '\0');
+    std::memcpy(&frame[0], hdr, sizeof(hdr));
+    if (!json.empty()) std::memcpy(&frame[sizeof(hdr)], json.data(), json.size());
+    return frame;
+}
+
+void IpcFrameDecoder::feed(const void* data, size_t size) {
+    if (m_failed) return;
+    // Drop consumed bytes before growing the buffer.
+    if (m_pos > 0 && m_pos == m_buf.size()) {
+        m_buf.clear();
+        m_pos = 0;
+    } else if (m_pos > 4096) {
+        m_buf.erase(0, m_pos);
+        m_pos = 0;
+    }
+    m_buf.append(static_cast<const char*>(data), size);
+}
+
+bool IpcFrameDecoder::next(IpcFrame& frame) {
+    if (m_failed || m_buf.size() - m_pos < 8) return false;
+    uint32_t hdr[2];
+    std::memcpy(hdr, m_buf.data() + m_pos, sizeof(hdr));
+    if (hdr[0] > kIpcPong || hdr[1] > kMaxPayload) {
+        m_failed = true;
+        return false;
+    }
+    if (m_buf.size() - m_pos - 8 < hdr[1]) return false;
+    frame.op = hdr[0];
+    frame.json.assign(m_buf, m_pos + 8, hdr[1]);
+    m_pos += 8 + hdr[1];
+    return true;
+}
+
+void IpcFrameDecoder::reset() {
+    m_buf.clear();
+    m_pos = 0;
+    m_failed = false;
+}
+
+namespace {
+
+void skip_ws(const std::string& s, size_t& i) {
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n')) ++i;
+}
+
+// s[i] is the opening quote. Leaves i past the closing quote; `out` gets the
+// unescaped text (\uXXXX above 0x7F is kept as '?').
+bool read_string(const std::string& s, size_t& i, std::string* out) {
+    ++i;
+    while (i < s.size()) {
+        const char c = s[i++];
+        if (c == '"') return true;
+        if (c != '\\') {
+            if (out) *out += c;
+            continue;
+        }
+        if (i >= s.size()) return false;
+        const char e = s[i++];
+        char u = e;
+        switch (e) {
+            case 'n': u = '\n'; break;
+            case 'r': u = '\r'; break;
+            case 't': u = '\t'; break;
+            case 'b': u = '\b'; break;
+            case 'f': u = '\f'; break;
+            case 'u': {
+                if (s.size() - i < 4) return false;
+                const unsigned long v = std::strtoul(s.substr(i, 4).c_str(), nullptr, 16);
+                i += 4;
+                u = v < 0x80 ? static_cast<char>(v) : '?';
+                break;
+            }
+            default: break; // \" \\ \/
+        }
+        if (out) *out += u;
+    }
+    return false;
+}
+
+// Skip one value starting at s[i] (string, object, array or a bare literal).
+bool skip_value(const std::string& s, size_t& i) {
+    if (i >= s.size()) return false;
+    if (s[i] == '"') return read_string(s, i, nullptr);
+    if (s[i] == '{' || s[i] == '[') {
+        int depth = 0;
+        while (i < s.size()) {
+            const char c = s[i];
+            if (c == '"') {
+                if (!read_string(s, i, nullptr)) return false;
+                continue;
+            }
+            ++i;
+            if (c == '{' || c == '[') ++depth;
+            else if ((c == '}' || c == ']') && --depth == 0) return true;
+        }
+        return false;
+    }
+    while (i < s.size() && s[i] != ',' && s[i] != '}' && s[i] != ']') ++i;
+    return true;
+}
+
+} // namespace
+
+bool json_top_level_string(const std::string& json, const char* key, std::string& out) {
+    size_t i = 0;
+    skip_ws(json, i);
+    if (i >= json.size() || json[i] != '{') return false;
+    ++i;
+    for (;;) {
+        skip_ws(json, i);
+        if (i >= json.size() || json[i] != '"') return false;
+        std::string name;
+        if (!read_string(json, i, &name)) return false;
+        skip_ws(json, i);
+        if (i >= json.size() || json[i] != ':') return false;
+        ++i;
+        skip_ws(json, i);
+        if (name == key) {
+            if (i >= json.size() || json[i] != '"') return false;
+            out.clear();
+            return read_string(json, i, &out);
+        }
+        if (!skip_value(json, i)) return false;
+        skip_ws(json, i);
+        if (i >= json.size() || json[i] != ',') return false;
+        ++i;
+    }
+}
+
+} // namespace efzda
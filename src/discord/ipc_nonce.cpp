@@ -0,0 +1,66 @@
+#include "discord/ipc_nonce.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+
+namespace efzda {
+
+namespace {
+
+uint32_t random_prefix() {
+    // random_device is the OS RNG on MSVC; the clock covers implementations
+    // where it is weak or throws.
+    uint64_t x = static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    try {
+        std::random_device rd;
+        x ^= (static_cast<uint64_t>(rd()) << 32) | rd();
+    } catch (...) {}
+    // splitmix64 finalizer
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<uint32_t>(x ^ (x >> 31));
+}
+
+} // namespace
+
+NonceGenerator::NonceGenerator() : NonceGenerator(random_prefix()) {}
+
+NonceGenerator::NonceGenerator(uint32_t prefix) {
+    static const char kHex[] = "0123456789abcdef";
+    for (int i = 0; i < 8; ++i) m_prefix[i] = kHex[(prefix >> (28 - 4 * i)) & 0xF];
+    m_prefix[8] = '-';
+    m_prefix[9] = '\0';
+}
+
+uint32_t NonceGenerator::next(char (&out)[kMaxLen]) {
+    const uint32_t seq = ++m_counter;
+    std::memcpy(out, m_prefix, 9);
+    char digits[10];
+    int n = 0;
+    uint32_t v = seq;
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    char* p = out + 9;
+    while (n) *p++ = digits[--n];
+    *p = '\0';
+    return seq;
+}
+
+bool NonceGenerator::sequenceOf(const std::string& nonce, uint32_t& seq) const {
+    if (nonce.size() < 10 || nonce.size() > kMaxLen - 1 || nonce.compare(0, 9, m_prefix) != 0) return false;
+    uint64_t v = 0;
+    for (size_t i = 9; i < nonce.size(); ++i) {
+        const char c = nonce[i];
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+    }
+    if (v == 0 || v > 0xFFFFFFFFull) return false;
+    seq = static_cast<uint32_t>(v);
+    return true;
+}
+
+} // namespace efzda
@@ -0,0 +1,233 @@
+#include "discord/ipc_transport.h"
+
+#ifdef _WIN32
+// Winsock 2 must come before windows.h; the build defines _WINSOCKAPI_ so
+// windows.h alone would not pull in the old winsock.h either.
+#undef _WINSOCKAPI_
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace efzda {
+
+std::vector<std::string> discord_ipc_socket_paths(const std::vector<std::string>& baseDirs) {
+    std::vector<std::string> bases = baseDirs;
+    if (bases.empty()) {
+        for (const char* var : {"XDG_RUNTIME_DIR", "TMPDIR"}) {
+            if (const char* v = std::getenv(var)) bases.emplace_back(v);
+        }
+        bases.emplace_back("/tmp");
+    }
+    static const char* const kSubdirs[] = {
+        "",
+        "app/com.discordapp.Discord/",
+        "app/com.discordapp.DiscordCanary/",
+        "snap.discord/",
+        "snap.discord-canary/",
+    };
+    std::vector<std::string> paths;
+    for (std::string base : bases) {
+        // Under Wine TMP/TMPDIR may hold a Windows path; only Unix ones can host the socket.
+        if (base.empty() || base[0] != '/') continue;
+        if (base.back() != '/') base += '/';
+        for (const char* sub : kSubdirs) {
+            for (int i = 0; i < 10; ++i) {
+                std::string p = base + sub + "discord-ipc-" + std::to_string(i);
+                bool seen = false;
+                for (const std::string& q : paths) seen = seen || q == p;
+                if (!seen) paths.push_back(std::move(p));
+            }
+        }
+    }
+    return paths;
+}
+
+#ifdef _WIN32
+
+// ---- NamedPipeTransport ----
+
+bool NamedPipeTransport::connect() {
+    close();
+    for (int i = 0; i < 10; ++i) {
+        wchar_t name[64];
+        swprintf_s(name, L"\\\\.\\pipe\\discord-ipc-%d", i);
+        HANDLE h = CreateFileW(name, GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (h != INVALID_HANDLE_VALUE) {
+            m_pipe = h;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NamedPipeTransport::write(const void* data, size_t size) {
+    if (!m_pipe) return false;
+    DWORD written = 0;
+    return WriteFile(m_pipe, data, static_cast<DWORD>(size), &written, nullptr) && written == size;
+}
+
+long NamedPipeTransport::read(void* data, size_t size) {
+    if (!m_pipe) return -1;
+    DWORD avail = 0;
+    if (!PeekNamedPipe(m_pipe, nullptr, 0, nullptr, &avail, nullptr)) return -1;
+    if (avail == 0) return 0;
+    DWORD got = 0;
+    const DWORD want = static_cast<DWORD>(size < avail ? size : avail);
+    if (!ReadFile(m_pipe, data, want, &got, nullptr)) return -1;
+    return static_cast<long>(got);
+}
+
+void NamedPipeTransport::close() {
+    if (m_pipe) CloseHandle(m_pipe);
+    m_pipe = nullptr;
+}
+
+// ---- UnixSocketTransport (Winsock AF_UNIX) ----
+
+static bool winsock_ready() {
+    static const bool s_ready = [] {
+        WSADATA wsa;
+        return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+    }();
+    return s_ready;
+}
+
+// Winsock wants a Windows path in sun_path. Wine can convert the Unix one;
+// otherwise assume the default Z: mapping of the Unix root.
+static std::string unix_to_dos_path(const std::string& unixPath) {
+    using WineGetDosFileName = WCHAR* (CDECL*)(LPCSTR);
+    static const auto s_toDos = reinterpret_cast<WineGetDosFileName>(
+        GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "wine_get_dos_file_name"));
+    if (s_toDos) {
+        if (WCHAR* w = s_toDos(unixPath.c_str())) {
+            char buf[MAX_PATH];
+            const int n = WideCharToMultiByte(CP_ACP, 0, w, -1, buf, sizeof(buf), nullptr, nullptr);
+            HeapFree(GetProcessHeap(), 0, w);
+            if (n > 0) return std::string(buf);
+        }
+    }
+    std::string dos = "Z:" + unixPath;
+    for (char& c : dos) if (c == '/') c = '\\';
+    return dos;
+}
+
+bool UnixSocketTransport::connect() {
+    close();
+    if (!winsock_ready()) return false;
+    for (const std::string& path : discord_ipc_socket_paths(m_baseDirs)) {
+        const std::string dos = unix_to_dos_path(path);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (dos.size() >= sizeof(addr.sun_path)) continue;
+        std::memcpy(addr.sun_path, dos.c_str(), dos.size() + 1);
+        SOCKET s = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s == INVALID_SOCKET) return false; // no AF_UNIX support (Windows < 10 1803, old Wine)
+        if (::connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+            m_socket = static_cast<uintptr_t>(s);
+            m_path = path;
+            return true;
+        }
+        closesocket(s);
+    }
+    return false;
+}
+
+bool UnixSocketTransport::write(const void* data, size_t size) {
+    if (m_socket == kNoSocket) return false;
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const int n = send(static_cast<SOCKET>(m_socket), p, static_cast<int>(size), 0);
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+long UnixSocketTransport::read(void* data, size_t size) {
+    if (m_socket == kNoSocket) return -1;
+    const SOCKET s = static_cast<SOCKET>(m_socket);
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(s, &readable);
+    timeval now{0, 0};
+    const int ready = select(0, &readable, nullptr, nullptr, &now);
+    if (ready < 0) return -1;
+    if (ready == 0) return 0;
+    const int n = recv(s, static_cast<char*>(data), static_cast<int>(size), 0);
+    return n > 0 ? n : -1; // 0: orderly close
+}
+
+void UnixSocketTransport::close() {
+    if (m_socket != kNoSocket) closesocket(static_cast<SOCKET>(m_socket));
+    m_socket = kNoSocket;
+    m_path.clear();
+}
+
+#else
+
+// ---- UnixSocketTransport (POSIX) ----
+
+bool UnixSocketTransport::connect() {
+    close();
+    for (const std::string& path : discord_ipc_socket_paths(m_baseDirs)) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) continue;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+            m_socket = static_cast<uintptr_t>(fd);
+            m_path = path;
+            return true;
+        }
+        ::close(fd);
+    }
+    return false;
+}
+
+bool UnixSocketTransport::write(const void* data, size_t size) {
+    if (m_socket == kNoSocket) return false;
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::send(static_cast<int>(m_socket), p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+long UnixSocketTransport::read(void* data, size_t size) {
+    if (m_socket == kNoSocket) return -1;
+    for (;;) {
+        const ssize_t n = ::recv(static_cast<int>(m_socket), data, size, MSG_DONTWAIT);
+        if (n > 0) return static_cast<long>(n);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        return -1; // 0: orderly close
+    }
+}
+
+void UnixSocketTransport::close() {
+    if (m_socket != kNoSocket) ::close(static_cast<int>(m_socket));
+    m_socket = kNoSocket;
+    m_path.clear();
+}
+
+#endif
+
+} // namespace efzda
@@ -0,0 +1,43 @@
+#include "discord/rate_limiter.h"
+
+#include <algorithm>
+
+namespace efzda {
+
+ActivityRateLimiter::ActivityRateLimiter(uint32_t burst, uint32_t windowMs)
+    : m_burst((std::max)(1u, (std::min)(burst, kMaxBurst))), m_windowMs(windowMs) {}
+
+void ActivityRateLimiter::expire(uint64_t nowMs) {
+    while (m_count > 0 && nowMs - m_spentAt[m_head] >= m_windowMs) {
+        m_head = (m_head + 1) % kMaxBurst;
+        --m_count;
+    }
+}
+
+uint32_t ActivityRateLimiter::available(uint64_t nowMs) {
+    expire(nowMs);
+    return m_burst - m_count;
+}
+
+uint64_t ActivityRateLimiter::waitMs(uint64_t nowMs, uint32_t tokens) {
+    tokens = (std::max)(1u, (std::min)(tokens, m_burst));
+    const uint32_t free = available(nowMs);
+    if (free >= tokens) return 0;
+    // The (tokens - free) oldest spends have to age out first.
+    const uint64_t spentAt = m_spentAt[(m_head + tokens - free - 1) % kMaxBurst];
+    return spentAt + m_windowMs - nowMs;
+}
+
+void ActivityRateLimiter::take(uint64_t nowMs, uint32_t tokens) {
+    expire(nowMs);
+    for (uint32_t i = 0; i < tokens; ++i) {
+        if (m_count == m_burst) { // over budget: forget the oldest
+            m_head = (m_head + 1) % kMaxBurst;
+            --m_count;
+        }
+        m_spentAt[(m_head + m_count) % kMaxBurst] = nowMs;
+        ++m_count;
+    }
+}
+
+} // namespace efzda
@@ -6,9 +6,12 @@
 
 #include "version.h"
 #include "logger.h"
+#include "trace.h"
 #include "config.h"
 #include "discord/discord_client.h"
+#include "discord/rate_limiter.h"
 #include "state/game_state_provider.h"
+#include "poll_scheduler.h"
 
 using namespace std::chrono_literals;
 
@@ -44,6 +47,7 @@ void worker_main(HMODULE hMod) {
     debug_trace(L"[EfzRichPresence] About to init_logger\n");
     efzda::init_logger(moduleDir);
     efzda::log("Stage: after init_logger");
+    efzda::trace_init();
     debug_trace(L"[EfzRichPresence] init_logger done\n");
     // Console disabled by default; opt-in via EFZDA_ENABLE_CONSOLE=1
     wchar_t envBuf[8];
@@ -73,7 +77,10 @@ void worker_main(HMODULE hMod) {
     }
 
     efzda::GameStateProvider provider;
+    provider.init(moduleDir);
+    efzda::GameEventQueue& events = provider.subscribe();
     efzda::GameState last{};
+    efzda::PresenceText lastText{}; // what was last sent; resends reuse it
     efzda::log("Stage: entering poll loop");
     debug_trace(L"[EfzRichPresence] Entering poll loop\n");
 
@@ -84,18 +91,23 @@ void worker_main(HMODULE hMod) {
         clearBeforeUpdate = GetEnvironmentVariableW(L"EFZDA_CLEAR_BEFORE_UPDATE", cbu, _countof(cbu)) > 0;
     } catch (...) {}
 
-    // Poll interval (ms). Default 500ms for responsiveness; override via EFZDA_POLL_MS
-    unsigned int pollMs = 500;
+    // Poll scheduling: 100ms while the state changes, decaying to a steady
+    // interval (default 500ms; override via EFZDA_POLL_MS) and 5s when the
+    // game is minimized or nothing changed for a minute.
+    efzda::PollSchedulerConfig schedCfg;
     try {
         wchar_t pbuf[16];
         if (GetEnvironmentVariableW(L"EFZDA_POLL_MS", pbuf, _countof(pbuf)) > 0) {
             unsigned long v = wcstoul(pbuf, nullptr, 10);
-            if (v >= 100 && v <= 5000) pollMs = static_cast<unsigned int>(v);
+            if (v >= 100 && v <= 5000) schedCfg.steadyMs = static_cast<uint32_t>(v);
         }
     } catch (...) {}
+    efzda::PollScheduler scheduler(schedCfg);
+    scheduler.setNotifySource(provider.exportNotifySource());
+    uint64_t prevFingerprint = 0;
 
     // Optional: force periodic updates even when state doesn't change to avoid clients getting "stuck".
-    // EFZDA_ALWAYS_UPDATE=1 => send every poll (beware of Discord rate limits)
+    // EFZDA_ALWAYS_UPDATE=1 => resend as often as Discord's rate limit allows
     // EFZDA_FORCE_UPDATE_MS=N => send at least once every N ms (default 20000 if var present with invalid value)
     bool alwaysUpdate = false;
     unsigned int forceUpdateMs = 0; // 0 = disabled
@@ -117,96 +129,81 @@ void worker_main(HMODULE hMod) {
             }
         }
     } catch (...) {}
+    // Unchanged activities are dropped by the writer unless forced; these
+    // two options force one through every forceUpdateMs.
+    if (alwaysUpdate) forceUpdateMs = efzda::kActivityWindowMs / efzda::kActivityBurst;
 
     // Kick: push an initial presence right away so Main Menu shows up even if state doesn't change soon
     try {
         auto cur0 = provider.get();
+        auto text0 = provider.materialize(cur0);
         if (discordReady) {
-            // Always clear once before first update to avoid sticky/null initial state
+            // Always clear once before first update to avoid sticky/null initial state;
+            // the writer sends both, clear first.
             discord.clearPresence();
-            std::this_thread::sleep_for(150ms);
-            discord.updatePresence(cur0.details, cur0.state,
-                                    cur0.smallImageKey, cur0.smallImageText,
-                                    cur0.largeImageKey, cur0.largeImageText);
+            discord.updatePresence(text0.details, text0.state,
+                                    text0.smallImageKey, text0.smallImageText,
+                                    text0.largeImageKey, text0.largeImageText);
         }
         last = cur0;
+        lastText = text0;
     } catch (...) {
         efzda::log("Initial presence push failed; continuing");
     }
 
-    // Small warm-up resend: Discord may ignore the very first SET_ACTIVITY immediately after handshake
-    // if its session isn't fully ready yet. Try again shortly to ensure Main Menu is visible.
-    if (discordReady) {
-        std::this_thread::sleep_for(250ms);
-        try {
-            if (clearBeforeUpdate) {
-                discord.clearPresence();
-                std::this_thread::sleep_for(50ms);
-            }
-            discord.updatePresence(last.details, last.state,
-                                    last.smallImageKey, last.smallImageText,
-                                    last.largeImageKey, last.largeImageText);
-        } catch (...) {
-            efzda::log("Warm-up presence resend failed; continuing");
-        }
-    }
-
-    const auto startTicks = GetTickCount64();
-    DWORD lastKickResend = 0;
-    ULONGLONG lastSentAt = 0; // last time we called updatePresence
+    ULONGLONG lastSentAt = 0; // last time we published a presence
     while (g_running.load(std::memory_order_relaxed)) {
         try {
             auto cur = provider.get();
-            bool changed = (cur != last);
+            bool activity = cur.fingerprint != prevFingerprint || provider.exportChanged();
+            prevFingerprint = cur.fingerprint;
+            efzda::GameEvent ev;
+            while (events.tryPop(ev)) {
+                activity = true;
+                EFZDA_TRACE(Session, Info, "Event: %s side=%d %ld -> %ld (poll %u)",
+                    efzda::game_event_name(ev.type), (int)ev.side, (long)ev.from, (long)ev.to, (unsigned)ev.poll);
+            }
+            scheduler.onPoll(activity, efzda::game_window_minimized());
+            provider.setPollIdle(scheduler.deep());
+            // One integer compare per poll; strings are only built when the
+            // fingerprint moved, and a moved fingerprint with identical text
+            // is not an update.
+            bool changed = false;
+            efzda::PresenceText text;
+            if (cur != last) {
+                text = provider.materialize(cur);
+                changed = (text != lastText);
+                if (!changed) last = cur;
+            }
             bool periodic = false;
-            if (!changed) {
-                if (alwaysUpdate) periodic = true;
-                else if (forceUpdateMs > 0) {
-                    ULONGLONG now = GetTickCount64();
-                    periodic = (lastSentAt == 0 || (now - lastSentAt) >= forceUpdateMs);
-                }
+            if (!changed && forceUpdateMs > 0) {
+                ULONGLONG now = GetTickCount64();
+                periodic = (lastSentAt == 0 || (now - lastSentAt) >= forceUpdateMs);
             }
             if (discordReady && (changed || periodic)) {
                 if (changed) {
-                    efzda::log("State change: details='%s' state='%s'", cur.details.c_str(), cur.state.c_str());
+                    efzda::log("State change: details='%s' state='%s'", text.details.c_str(), text.state.c_str());
+                } else {
+                    text = lastText;
                 }
-                if (clearBeforeUpdate) {
-                    discord.clearPresence();
-                    // Tiny delay to let Discord register the clear
-                    std::this_thread::sleep_for(50ms);
-                }
-                discord.updatePresence(cur.details, cur.state,
-                                        cur.smallImageKey, cur.smallImageText,
-                                        cur.largeImageKey, cur.largeImageText);
+                if (clearBeforeUpdate) discord.clearPresence();
+                discord.updatePresence(text.details, text.state,
+                                        text.smallImageKey, text.smallImageText,
+                                        text.largeImageKey, text.largeImageText,
+                                        periodic);
                 last = cur; // even if identical, keep last in sync
+                lastText = text;
                 lastSentAt = GetTickCount64();
             }
-            // Kick window: For the first 5 seconds after startup, resend the last
-            // snapshot about once per second even without a state change. Some
-            // Discord clients ignore the very first update immediately after handshake.
-            if (discordReady) {
-                DWORD now = GetTickCount();
-                if (GetTickCount64() - startTicks < 5000ULL) {
-                    if (lastKickResend == 0 || now - lastKickResend >= 1000) {
-                        if (clearBeforeUpdate) {
-                            discord.clearPresence();
-                            std::this_thread::sleep_for(50ms);
-                        }
-                        discord.updatePresence(last.details, last.state,
-                                                last.smallImageKey, last.smallImageText,
-                                                last.largeImageKey, last.largeImageText);
-                        lastKickResend = now;
-                    }
-                }
-            }
             if (discordReady)
                 discord.poll();
         } catch (...) {
             efzda::log("Worker loop caught unexpected exception; continuing");
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(pollMs));
+        if (scheduler.wait() == efzda::PollWake::Notify) provider.exportNotified();
     }
 
+    provider.shutdown();
     if (discordReady) {
         discord.clearPresence();
         discord.shutdown();
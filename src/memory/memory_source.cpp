@@ -0,0 +1,68 @@
+#include "memory/memory_source.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <cstring>
+
+namespace efzda {
+
+#ifdef _WIN32
+bool ProcessMemorySource::read(uintptr_t address, void* out, size_t size) {
+    ++m_stats.reads;
+    if (!address || !out || size == 0) {
+        ++m_stats.failures;
+        return false;
+    }
+    ++m_stats.syscalls;
+    m_stats.bytes += size;
+    SIZE_T got = 0;
+    const bool ok = ReadProcessMemory(GetCurrentProcess(), reinterpret_cast<const void*>(address), out, size, &got) &&
+                    got == size;
+    if (!ok) ++m_stats.failures;
+    return ok;
+}
+#endif
+
+void FakeMemorySource::map(uintptr_t address, size_t size) {
+    m_blocks[address] = std::vector<uint8_t>(size, 0);
+}
+
+const std::vector<uint8_t>* FakeMemorySource::find(uintptr_t address, size_t size, uintptr_t& blockStart) const {
+    auto it = m_blocks.upper_bound(address);
+    if (it == m_blocks.begin()) return nullptr;
+    --it;
+    const uintptr_t start = it->first;
+    const size_t len = it->second.size();
+    if (address - start > len || size > len - (address - start)) return nullptr;
+    blockStart = start;
+    return &it->second;
+}
+
+bool FakeMemorySource::write(uintptr_t address, const void* data, size_t size) {
+    uintptr_t start = 0;
+    auto* block = const_cast<std::vector<uint8_t>*>(find(address, size, start));
+    if (!block) return false;
+    std::memcpy(block->data() + (address - start), data, size);
+    return true;
+}
+
+bool FakeMemorySource::read(uintptr_t address, void* out, size_t size) {
+    ++m_stats.reads;
+    if (!address || !out || size == 0) {
+        ++m_stats.failures;
+        return false;
+    }
+    ++m_stats.syscalls;
+    m_stats.bytes += size;
+    uintptr_t start = 0;
+    const auto* block = find(address, size, start);
+    if (!block) {
+        ++m_stats.failures;
+        return false;
+    }
+    std::memcpy(out, block->data() + (address - start), size);
+    return true;
+}
+
+} // namespace efzda
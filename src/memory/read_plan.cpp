@@ -0,0 +1,222 @@
+#include "memory/read_plan.h"
+
+#include <algorithm>
+
+namespace efzda {
+
+// ---- ReadPlanBuilder --------------------------------------------------------
+
+ReadFieldId ReadPlanBuilder::intern(const Decl& d) {
+    for (size_t i = 0; i < m_decls.size(); ++i) {
+        const Decl& e = m_decls[i];
+        if (e.indirect == d.indirect && e.root == d.root && e.parent == d.parent &&
+            e.offset == d.offset && e.size == d.size) {
+            return static_cast<ReadFieldId>(i);
+        }
+    }
+    if (m_decls.size() >= kInvalidReadField) return kInvalidReadField;
+    m_decls.push_back(d);
+    return static_cast<ReadFieldId>(m_decls.size() - 1);
+}
+
+ReadFieldId ReadPlanBuilder::add(ReadRoot root, uintptr_t offset, uint32_t size) {
+    if (size == 0) return kInvalidReadField;
+    return intern(Decl{false, root, kInvalidReadField, offset, size, 0});
+}
+
+ReadFieldId ReadPlanBuilder::addIndirect(ReadFieldId parent, uintptr_t offset, uint32_t size) {
+    if (size == 0 || parent >= m_decls.size() || m_decls[parent].size != sizeof(uintptr_t))
+        return kInvalidReadField;
+    const uint16_t depth = static_cast<uint16_t>(m_decls[parent].depth + 1);
+    return intern(Decl{true, ReadRoot::Efz, parent, offset, size, depth});
+}
+
+ReadPlan ReadPlanBuilder::compile(const ReadPlanOptions& options) const {
+    ReadPlan plan;
+    plan.m_fields.resize(m_decls.size());
+
+    // Group fields by anchor (root module or parent pointer field).
+    std::vector<ReadFieldId> ids(m_decls.size());
+    for (size_t i = 0; i < ids.size(); ++i) ids[i] = static_cast<ReadFieldId>(i);
+    auto anchorKey = [&](ReadFieldId id) -> uint32_t {
+        const Decl& d = m_decls[id];
+        return d.indirect ? static_cast<uint32_t>(kReadRootCount + d.parent) : static_cast<uint32_t>(d.root);
+    };
+    std::sort(ids.begin(), ids.end(), [&](ReadFieldId a, ReadFieldId b) {
+        const Decl& da = m_decls[a];
+        const Decl& db = m_decls[b];
+        if (da.depth != db.depth) return da.depth < db.depth;
+        const uint32_t ka = anchorKey(a), kb = anchorKey(b);
+        if (ka != kb) return ka < kb;
+        if (da.offset != db.offset) return da.offset < db.offset;
+        return da.size > db.size;
+    });
+
+    // Sweep each anchor group in offset order and coalesce neighbours.
+    uint32_t bufferSize = 0;
+    for (size_t i = 0; i < ids.size();) {
+        const Decl& first = m_decls[ids[i]];
+        const uint32_t key = anchorKey(ids[i]);
+        ReadPlan::Span span{};
+        span.indirect = first.indirect;
+        span.root = first.root;
+        span.parent = first.parent;
+        span.offset = first.offset;
+        span.depth = first.depth;
+        span.firstField = static_cast<uint16_t>(plan.m_order.size());
+        uintptr_t end = first.offset + first.size;
+
+        size_t j = i;
+        for (; j < ids.size() && anchorKey(ids[j]) == key; ++j) {
+            const Decl& d = m_decls[ids[j]];
+            const uintptr_t dEnd = d.offset + d.size;
+            if (j != i) {
+                const bool close = d.offset <= end + options.maxGap;
+                const bool fits = (std::max(end, dEnd) - span.offset) <= options.maxSpan;
+                if (!close || !fits) break;
+            }
+            end = std::max(end, dEnd);
+            plan.m_order.push_back(ids[j]);
+        }
+        span.size = static_cast<uint32_t>(end - span.offset);
+        span.fieldCount = static_cast<uint16_t>(plan.m_order.size() - span.firstField);
+        span.bufferOffset = bufferSize;
+        bufferSize += span.size;
+
+        const uint16_t spanIndex = static_cast<uint16_t>(plan.m_spans.size());
+        for (uint16_t k = 0; k < span.fieldCount; ++k) {
+            const ReadFieldId id = plan.m_order[span.firstField + k];
+            ReadPlan::Field& f = plan.m_fields[id];
+            f.span = spanIndex;
+            f.offsetInSpan = static_cast<uint32_t>(m_decls[id].offset - span.offset);
+            f.size = m_decls[id].size;
+        }
+        plan.m_spans.push_back(span);
+        i = j;
+    }
+    plan.m_bufferSize = bufferSize;
+    return plan;
+}
+
+// ---- ReadPlan ----------------------------------------------------------------
+
+void ReadPlan::execute(MemorySource& source, const uintptr_t (&roots)[kReadRootCount], ReadPlanResult& out) const {
+    out.m_plan = this;
+    out.m_buffer.assign(m_bufferSize, 0);
+    out.m_spanBase.assign(m_spans.size(), 0);
+    out.m_spanOk.assign(m_spans.size(), 0);
+    out.m_fieldOk.assign(m_fields.size(), 0);
+    out.m_spansRead = 0;
+    out.m_spansFailed = 0;
+
+    for (size_t s = 0; s < m_spans.size(); ++s) {
+        const Span& span = m_spans[s];
+        uintptr_t anchor = 0;
+        if (!span.indirect) {
+            anchor = roots[static_cast<size_t>(span.root)];
+        } else if (!out.get(span.parent, anchor)) {
+            anchor = 0;
+        }
+        if (!anchor) continue; // unresolved hop: every field stays invalid
+
+        const uintptr_t base = anchor + span.offset;
+        out.m_spanBase[s] = base;
+        uint8_t* dst = out.m_buffer.data() + span.bufferOffset;
+        ++out.m_spansRead;
+        if (source.read(base, dst, span.size)) {
+            out.m_spanOk[s] = 1;
+            for (uint16_t k = 0; k < span.fieldCount; ++k) out.m_fieldOk[m_order[span.firstField + k]] = 1;
+            continue;
+        }
+        ++out.m_spansFailed;
+        // A coalesced span may cross into an unreadable page that none of the
+        // individual fields touch; retry field by field before giving up.
+        if (span.fieldCount < 2) continue;
+        for (uint16_t k = 0; k < span.fieldCount; ++k) {
+            const ReadFieldId id = m_order[span.firstField + k];
+            const Field& f = m_fields[id];
+            if (source.read(base + f.offsetInSpan, dst + f.offsetInSpan, f.size)) out.m_fieldOk[id] = 1;
+        }
+    }
+}
+
+// ---- ReadPlanResult -----------------------------------------------------------
+
+bool ReadPlanResult::valid(ReadFieldId id) const {
+    return m_plan && id < m_fieldOk.size() && m_fieldOk[id] != 0;
+}
+
+const uint8_t* ReadPlanResult::bytes(ReadFieldId id) const {
+    if (!valid(id)) return nullptr;
+    const ReadPlan::Field& f = m_plan->m_fields[id];
+    return m_buffer.data() + m_plan->m_spans[f.span].bufferOffset + f.offsetInSpan;
+}
+
+uint32_t ReadPlanResult::fieldSize(ReadFieldId id) const {
+    if (!m_plan || id >= m_plan->m_fields.size()) return 0;
+    return m_plan->m_fields[id].size;
+}
+
+uintptr_t ReadPlanResult::address(ReadFieldId id) const {
+    if (!m_plan || id >= m_plan->m_fields.size()) return 0;
+    const ReadPlan::Field& f = m_plan->m_fields[id];
+    const uintptr_t base = m_spanBase[f.span];
+    return base ? base + f.offsetInSpan : 0;
+}
+
+bool ReadPlanResult::lookup(uintptr_t address, void* out, size_t size) const {
+    if (!m_plan || !address || size == 0) return false;
+    for (size_t s = 0; s < m_plan->m_spans.size(); ++s) {
+        const uintptr_t base = m_spanBase[s];
+        const ReadPlan::Span& span = m_plan->m_spans[s];
+        if (!base || address < base || address - base > span.size || size > span.size - (address - base))
+            continue;
+        const uint32_t rel = static_cast<uint32_t>(address - base);
+        if (!m_spanOk[s]) {
+            // Span fell back to per-field reads: only ranges inside one
+            // successfully read field are trustworthy.
+            bool covered = false;
+            for (uint16_t k = 0; k < span.fieldCount && !covered; ++k) {
+                const ReadFieldId id = m_plan->m_order[span.firstField + k];
+                const ReadPlan::Field& f = m_plan->m_fields[id];
+                covered = m_fieldOk[id] && rel >= f.offsetInSpan && rel + size <= f.offsetInSpan + f.size;
+            }
+            if (!covered) continue;
+        }
+        std::memcpy(out, m_buffer.data() + span.bufferOffset + rel, size);
+        return true;
+    }
+    return false;
+}
+
+uint64_t ReadPlanResult::fingerprint() const {
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](uint8_t b) {
+        h ^= b;
+        h *= 1099511628211ULL;
+    };
+    if (!m_plan) return h;
+    for (size_t id = 0; id < m_plan->m_fields.size(); ++id) {
+        const uint8_t* p = bytes(static_cast<ReadFieldId>(id));
+        mix(p ? 1 : 0);
+        if (!p) continue;
+        for (uint32_t i = 0; i < m_plan->m_fields[id].size; ++i) mix(p[i]);
+    }
+    return h;
+}
+
+// ---- ReadPlanOverlay ----------------------------------------------------------
+
+bool ReadPlanOverlay::read(uintptr_t address, void* out, size_t size) {
+    ++m_stats.reads;
+    m_stats.bytes += size;
+    if (m_snapshot.lookup(address, out, size)) {
+        ++m_hits;
+        return true;
+    }
+    const bool ok = m_fallback.read(address, out, size);
+    if (!ok) ++m_stats.failures;
+    return ok;
+}
+
+} // namespace efzda
@@ -0,0 +1,164 @@
+#include "memory/region_map.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fstream>
+#include <string>
+#endif
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace efzda {
+
+// ---- RegionMap ----------------------------------------------------------------
+
+bool RegionMap::cachedCovers(uintptr_t address, size_t size) const {
+    // Regions are merged on insert, so a covered range sits in one entry.
+    auto it = std::upper_bound(m_regions.begin(), m_regions.end(), address,
+                               [](uintptr_t a, const Region& r) { return a < r.base; });
+    if (it == m_regions.begin()) return false;
+    --it;
+    return address >= it->base && address < it->end && size <= it->end - address;
+}
+
+void RegionMap::insert(const Region& r) {
+    if (r.end <= r.base) return;
+    if (m_regions.empty()) m_builtAt = std::chrono::steady_clock::now();
+    Region merged = r;
+    auto first = std::lower_bound(m_regions.begin(), m_regions.end(), merged.base,
+                                  [](const Region& e, uintptr_t a) { return e.end < a; });
+    auto last = first;
+    while (last != m_regions.end() && last->base <= merged.end) {
+        merged.base = std::min(merged.base, last->base);
+        merged.end = std::max(merged.end, last->end);
+        ++last;
+    }
+    first = m_regions.erase(first, last);
+    m_regions.insert(first, merged);
+}
+
+void RegionMap::invalidate() {
+    m_regions.clear();
+    ++m_generation;
+}
+
+void RegionMap::expireIfStale() {
+    if (m_regions.empty() || m_maxAge.count() <= 0) return;
+    if (std::chrono::steady_clock::now() - m_builtAt > m_maxAge) invalidate();
+}
+
+bool RegionMap::covers(uintptr_t address, size_t size) {
+    if (!address || size == 0 || address + size < address) return false;
+    expireIfStale();
+    if (cachedCovers(address, size)) return true;
+
+    // Walk the range, asking the backend for each uncovered piece. A read can
+    // legitimately straddle two regions with different protections.
+    const uintptr_t end = address + size;
+    uintptr_t cur = address;
+    while (cur < end) {
+        if (!cachedCovers(cur, 1) && (!populate(cur) || !cachedCovers(cur, 1))) return false;
+        auto it = std::upper_bound(m_regions.begin(), m_regions.end(), cur,
+                                   [](uintptr_t a, const Region& r) { return a < r.base; });
+        cur = (--it)->end;
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+static bool is_readable(const MEMORY_BASIC_INFORMATION& mbi) {
+    if (mbi.State != MEM_COMMIT) return false;
+    if (mbi.Protect & (PAGE_GUARD | PAGE_NOACCESS)) return false;
+    const DWORD prot = mbi.Protect & 0xFF;
+    return prot == PAGE_READONLY || prot == PAGE_READWRITE || prot == PAGE_WRITECOPY ||
+           prot == PAGE_EXECUTE_READ || prot == PAGE_EXECUTE_READWRITE || prot == PAGE_EXECUTE_WRITECOPY;
+}
+
+bool RegionMap::populate(uintptr_t address) {
+    MEMORY_BASIC_INFORMATION mbi{};
+    ++m_queries;
+    if (VirtualQuery(reinterpret_cast<LPCVOID>(address), &mbi, sizeof(mbi)) != sizeof(mbi)) return false;
+    if (!is_readable(mbi)) return false;
+    const uintptr_t base = reinterpret_cast<uintptr_t>(mbi.BaseAddress);
+    insert(Region{base, base + mbi.RegionSize});
+    return true;
+}
+
+#else
+
+// /proc/self/maps lines look like "08048000-08056000 r-xp 00000000 03:0c 64593 /usr/sbin/gpm".
+bool RegionMap::populate(uintptr_t address) {
+    ++m_queries;
+    std::ifstream maps("/proc/self/maps");
+    if (!maps) return false;
+    m_regions.clear();
+    std::string line;
+    while (std::getline(maps, line)) {
+        const char* p = line.c_str();
+        char* endp = nullptr;
+        const unsigned long long lo = std::strtoull(p, &endp, 16);
+        if (!endp || *endp != '-') continue;
+        const unsigned long long hi = std::strtoull(endp + 1, &endp, 16);
+        if (!endp || *endp != ' ' || endp[1] != 'r') continue;
+        insert(Region{static_cast<uintptr_t>(lo), static_cast<uintptr_t>(hi)});
+    }
+    return cachedCovers(address, 1);
+}
+
+#endif
+
+// ---- RegionMapMemorySource -------------------------------------------------------
+
+#if defined(_WIN32) && defined(_MSC_VER)
+// The map can be stale for up to maxAge (the game frees session objects on its
+// own thread), so the copy itself is still guarded. Kept free of C++ objects
+// so __try is allowed.
+static bool guarded_copy(void* out, const void* src, size_t size) {
+    __try {
+        std::memcpy(out, src, size);
+        return true;
+    } __except (GetExceptionCode() == EXCEPTION_ACCESS_VIOLATION ? EXCEPTION_EXECUTE_HANDLER
+                                                                  : EXCEPTION_CONTINUE_SEARCH) {
+        return false;
+    }
+}
+#elif defined(_WIN32)
+// No SEH without MSVC (MinGW): let the kernel do the guarded copy instead.
+static bool guarded_copy(void* out, const void* src, size_t size) {
+    SIZE_T got = 0;
+    return ReadProcessMemory(GetCurrentProcess(), src, out, size, &got) && got == size;
+}
+#else
+// POSIX is only used for tests, where the maps parse is authoritative.
+static bool guarded_copy(void* out, const void* src, size_t size) {
+    std::memcpy(out, src, size);
+    return true;
+}
+#endif
+
+bool RegionMapMemorySource::read(uintptr_t address, void* out, size_t size) {
+    ++m_stats.reads;
+    if (!address || !out || size == 0) {
+        ++m_stats.failures;
+        return false;
+    }
+    m_stats.bytes += size;
+    const uint32_t before = m_map.queries();
+    const bool valid = m_map.covers(address, size);
+    m_stats.syscalls += m_map.queries() - before;
+    if (!valid) {
+        ++m_stats.failures;
+        return false;
+    }
+    if (!guarded_copy(out, reinterpret_cast<const void*>(address), size)) {
+        m_map.invalidate();
+        ++m_stats.failures;
+        return false;
+    }
+    return true;
+}
+
+} // namespace efzda
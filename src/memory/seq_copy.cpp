@@ -0,0 +1,74 @@
+#include "memory/seq_copy.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace efzda {
+
+// Byte-wise little-endian load, so an unaligned offset is fine.
+static uint32_t load_seq(const volatile uint8_t* base, size_t offset) {
+    const volatile uint8_t* p = base + offset;
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void copy_block(uint8_t* out, const volatile uint8_t* live, size_t size) {
+    std::memcpy(out, const_cast<const uint8_t*>(live), size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+SeqCopyReader::Result SeqCopyReader::read(const void* live, size_t size, size_t seqOffset) {
+    if (!live || size == 0 || size > kMaxSize) {
+        ++m_stats.failed;
+        return Result::Torn;
+    }
+    const bool haveSeq = seqOffset != kNoSeq && seqOffset + sizeof(uint32_t) <= size;
+    const volatile uint8_t* src = static_cast<const volatile uint8_t*>(live);
+
+    if (haveSeq && m_valid && m_size == size && m_seqOffset == seqOffset && load_seq(src, seqOffset) == m_seq) {
+        ++m_stats.unchanged;
+        return Result::Unchanged;
+    }
+
+    for (unsigned attempt = 0; attempt <= m_maxRetries; ++attempt) {
+        if (attempt) ++m_stats.retries;
+        const uint32_t before = haveSeq ? load_seq(src, seqOffset) : 0;
+        copy_block(m_attempt, src, size);
+        // Give a writer that was preempted mid-update the chance to finish,
+        // so the second copy differs instead of repeating the same tear. A
+        // yield is not enough on one core: the scheduler often hands the
+        // CPU straight back, so actually sleep.
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        copy_block(m_check, src, size);
+        const uint32_t after = haveSeq ? load_seq(src, seqOffset) : 0;
+        bool ok = std::memcmp(m_attempt, m_check, size) == 0;
+        if (ok && haveSeq) {
+            uint32_t inside;
+            std::memcpy(&inside, m_attempt + seqOffset, sizeof(inside));
+            ok = before == after && inside == before;
+        }
+        if (ok) {
+            std::memcpy(m_copy, m_attempt, size);
+            m_valid = true;
+            m_size = size;
+            m_seqOffset = haveSeq ? seqOffset : kNoSeq;
+            m_seq = before;
+            ++m_stats.copied;
+            return Result::Copied;
+        }
+        ++m_stats.torn;
+    }
+    ++m_stats.failed;
+    return Result::Torn;
+}
+
+void SeqCopyReader::reset() {
+    m_valid = false;
+    m_size = 0;
+    m_seqOffset = kNoSeq;
+    m_seq = 0;
+}
+
+} // namespace efzda
@@ -0,0 +1,256 @@
+#include "memory/snapshot_file.h"
+
+#include <cstring>
+
+namespace efzda {
+
+static const char kSnapshotMagic[8] = {'E', 'F', 'Z', 'S', 'N', 'A', 'P', '\0'};
+
+static size_t pad8(size_t n) { return (n + 7) & ~size_t(7); }
+
+// magic, version, structSize: the part of the netplay export every version has.
+static constexpr uint32_t kExportHeaderSize = 12;
+
+static bool valid_file_header(const SnapshotFileHeader& h) {
+    return std::memcmp(h.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0 &&
+           h.version == kSnapshotFormatVersion && h.headerSize == sizeof(SnapshotFileHeader);
+}
+
+// ---- SnapshotWriter ----------------------------------------------------------------
+
+bool SnapshotWriter::open(const SnapshotPath& path) {
+    close();
+#ifdef _WIN32
+    m_file = _wfopen(path.c_str(), L"ab+");
+#else
+    m_file = std::fopen(path.c_str(), "ab+");
+#endif
+    if (!m_file) return false;
+    std::fseek(m_file, 0, SEEK_END);
+    if (std::ftell(m_file) == 0) {
+        SnapshotFileHeader h{};
+        std::memcpy(h.magic, kSnapshotMagic, sizeof(h.magic));
+        h.version = kSnapshotFormatVersion;
+        h.headerSize = sizeof(SnapshotFileHeader);
+        h.pointerSize = sizeof(uintptr_t);
+        if (std::fwrite(&h, sizeof(h), 1, m_file) != 1) {
+            close();
+            return false;
+        }
+        std::fflush(m_file);
+        return true;
+    }
+    // Appending to an older or foreign file would make it unreadable.
+    SnapshotFileHeader h{};
+    std::fseek(m_file, 0, SEEK_SET);
+    const bool ok = std::fread(&h, sizeof(h), 1, m_file) == 1 && valid_file_header(h);
+    std::fseek(m_file, 0, SEEK_END);
+    if (!ok) close();
+    return ok;
+}
+
+void SnapshotWriter::close() {
+    if (m_file) std::fclose(m_file);
+    m_file = nullptr;
+    m_inPoll = false;
+}
+
+void SnapshotWriter::beginPoll(const SnapshotPollHeader& header) {
+    m_header = header;
+    m_reads.clear();
+    m_data.clear();
+    m_export.clear();
+    m_header.exportSource = kSnapshotExportNone;
+    m_inPoll = m_file != nullptr;
+}
+
+void SnapshotWriter::addRead(uintptr_t address, const void* data, size_t size, bool ok) {
+    if (!m_inPoll) return;
+    SnapshotReadEntry e{};
+    e.address = address;
+    e.size = static_cast<uint32_t>(size);
+    e.dataOffset = kSnapshotReadFailed;
+    if (ok && data && size) {
+        e.dataOffset = static_cast<uint32_t>(m_data.size());
+        const auto* p = static_cast<const uint8_t*>(data);
+        m_data.insert(m_data.end(), p, p + size);
+    }
+    m_reads.push_back(e);
+}
+
+void SnapshotWriter::setExport(SnapshotExportSource source, const void* data, size_t size) {
+    if (!m_inPoll) return;
+    m_header.exportSource = source;
+    const auto* p = static_cast<const uint8_t*>(data);
+    m_export.assign(p, p + (data ? size : 0));
+}
+
+bool SnapshotWriter::endPoll() {
+    if (!m_inPoll) return false;
+    m_inPoll = false;
+
+    const size_t readsBytes = m_reads.size() * sizeof(SnapshotReadEntry);
+    const size_t total = sizeof(SnapshotPollHeader) + readsBytes + pad8(m_data.size()) + pad8(m_export.size());
+    m_header.magic = kSnapshotPollMagic;
+    m_header.recordSize = static_cast<uint32_t>(total);
+    m_header.readCount = static_cast<uint32_t>(m_reads.size());
+    m_header.exportSize = static_cast<uint32_t>(m_export.size());
+    m_header.dataSize = static_cast<uint32_t>(m_data.size());
+
+    // One fwrite per poll keeps a torn record at the very end of the file.
+    m_record.assign(total, 0);
+    uint8_t* out = m_record.data();
+    std::memcpy(out, &m_header, sizeof(m_header));
+    out += sizeof(m_header);
+    if (readsBytes) std::memcpy(out, m_reads.data(), readsBytes);
+    out += readsBytes;
+    if (!m_data.empty()) std::memcpy(out, m_data.data(), m_data.size());
+    out += pad8(m_data.size());
+    if (!m_export.empty()) std::memcpy(out, m_export.data(), m_export.size());
+
+    if (std::fwrite(m_record.data(), 1, total, m_file) != total) {
+        close();
+        return false;
+    }
+    std::fflush(m_file);
+    ++m_pollsWritten;
+    return true;
+}
+
+// ---- SnapshotReader ----------------------------------------------------------------
+
+bool snapshot_export_complete(const uint8_t* bytes, uint32_t size) {
+    if (!bytes || size < kExportHeaderSize) return false;
+    uint32_t structSize = 0;
+    std::memcpy(&structSize, bytes + 8, sizeof(structSize));
+    return structSize <= size;
+}
+
+bool SnapshotReader::load(const SnapshotPath& path, std::string* error) {
+#ifdef _WIN32
+    std::FILE* f = _wfopen(path.c_str(), L"rb");
+#else
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+#endif
+    if (!f) {
+        if (error) *error = "cannot open snapshot file";
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    std::fseek(f, 0, SEEK_END);
+    const long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size > 0) {
+        bytes.resize(static_cast<size_t>(size));
+        bytes.resize(std::fread(bytes.data(), 1, bytes.size(), f));
+    }
+    std::fclose(f);
+    return loadBytes(std::move(bytes), error);
+}
+
+bool SnapshotReader::loadBytes(std::vector<uint8_t> bytes, std::string* error) {
+    m_bytes = std::move(bytes);
+    m_polls.clear();
+    m_truncated = false;
+    m_pointerSize = 0;
+
+    SnapshotFileHeader fh{};
+    if (m_bytes.size() < sizeof(fh)) {
+        if (error) *error = "not a snapshot file";
+        return false;
+    }
+    std::memcpy(&fh, m_bytes.data(), sizeof(fh));
+    if (!valid_file_header(fh)) {
+        if (error) *error = "not a snapshot file or unsupported version";
+        return false;
+    }
+    m_pointerSize = fh.pointerSize;
+
+    size_t pos = sizeof(fh);
+    while (pos < m_bytes.size()) {
+        const size_t left = m_bytes.size() - pos;
+        const auto* h = reinterpret_cast<const SnapshotPollHeader*>(m_bytes.data() + pos);
+        if (left < sizeof(SnapshotPollHeader) || h->magic != kSnapshotPollMagic || h->recordSize > left) {
+            m_truncated = true;
+            break;
+        }
+        const size_t readsBytes = size_t(h->readCount) * sizeof(SnapshotReadEntry);
+        const size_t need = sizeof(SnapshotPollHeader) + readsBytes + pad8(h->dataSize) + pad8(h->exportSize);
+        if (need != h->recordSize) {
+            m_truncated = true;
+            break;
+        }
+        SnapshotPoll p;
+        p.header = h;
+        p.reads = reinterpret_cast<const SnapshotReadEntry*>(m_bytes.data() + pos + sizeof(SnapshotPollHeader));
+        p.data = m_bytes.data() + pos + sizeof(SnapshotPollHeader) + readsBytes;
+        p.exportBytes = h->exportSize ? p.data + pad8(h->dataSize) : nullptr;
+        bool entriesOk = true;
+        for (uint32_t i = 0; i < h->readCount && entriesOk; ++i) {
+            const SnapshotReadEntry& e = p.reads[i];
+            entriesOk = e.dataOffset == kSnapshotReadFailed ||
+                        (e.dataOffset <= h->dataSize && e.size <= h->dataSize - e.dataOffset);
+        }
+        // An export cut shorter than the structSize it declares would be
+        // parsed past its end.
+        if (!entriesOk || (h->exportSize && !snapshot_export_complete(p.exportBytes, h->exportSize))) {
+            m_truncated = true;
+            break;
+        }
+        m_polls.push_back(p);
+        pos += h->recordSize;
+    }
+    return true;
+}
+
+// ---- RecordingMemorySource ---------------------------------------------------------
+
+bool RecordingMemorySource::read(uintptr_t address, void* out, size_t size) {
+    const MemoryReadStats before = m_inner.stats();
+    const bool ok = m_inner.read(address, out, size);
+    const MemoryReadStats& after = m_inner.stats();
+    m_stats.reads += after.reads - before.reads;
+    m_stats.syscalls += after.syscalls - before.syscalls;
+    m_stats.bytes += after.bytes - before.bytes;
+    m_stats.failures += after.failures - before.failures;
+    m_writer.addRead(address, out, size, ok);
+    return ok;
+}
+
+// ---- ReplayMemorySource ------------------------------------------------------------
+
+bool ReplayMemorySource::serve(uint32_t i, uintptr_t address, void* out, size_t size) const {
+    const SnapshotReadEntry& e = m_poll->reads[i];
+    if (e.dataOffset == kSnapshotReadFailed) return false;
+    if (address < e.address || address - e.address > e.size || size > e.size - (address - e.address)) return false;
+    std::memcpy(out, m_poll->data + e.dataOffset + (address - e.address), size);
+    return true;
+}
+
+bool ReplayMemorySource::read(uintptr_t address, void* out, size_t size) {
+    ++m_stats.reads;
+    if (!m_poll || !address || !out || size == 0) {
+        ++m_stats.failures;
+        return false;
+    }
+    m_stats.bytes += size;
+    const uint32_t count = m_poll->header->readCount;
+
+    // Same read as at recording time: replay its outcome, failures included.
+    if (m_cursor < count) {
+        const SnapshotReadEntry& e = m_poll->reads[m_cursor];
+        if (e.address == address && e.size == size) {
+            const bool ok = serve(m_cursor++, address, out, size);
+            if (!ok) ++m_stats.failures;
+            return ok;
+        }
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        if (serve(i, address, out, size)) return true;
+    }
+    ++m_unrecorded;
+    ++m_stats.failures;
+    return false;
+}
+
+} // namespace efzda
@@ -0,0 +1,213 @@
+#include "poll_scheduler.h"
+#include "trace.h"
+#include "wait_source.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <poll.h>
+
+#include <cerrno>
+#include <chrono>
+#endif
+
+namespace efzda {
+
+#ifdef _WIN32
+using LocalWaitSource = Win32EventWaitSource;
+#else
+using LocalWaitSource = EventFdWaitSource;
+#endif
+
+static uint64_t now_ms() {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+PollScheduler::PollScheduler(const PollSchedulerConfig& cfg) : m_cfg(cfg) {
+#ifdef _WIN32
+    // High-resolution timers need Windows 10 1803+; older systems get the
+    // regular (~15.6 ms granularity) timer.
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!m_timer) m_timer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+#endif
+    m_wake = std::make_unique<LocalWaitSource>();
+    if (!m_wake->isOpen()) m_wake.reset();
+    m_intervalMs = m_cfg.fastMs;
+    const uint64_t now = now_ms();
+    m_lastPollAt = now;
+    m_lastChangeAt = now;
+    m_windowStart = now;
+}
+
+PollScheduler::~PollScheduler() {
+#ifdef _WIN32
+    if (m_timer) CloseHandle(m_timer);
+#endif
+}
+
+void PollScheduler::onPoll(bool changed, bool gameMinimized) {
+    const uint64_t now = now_ms();
+    if (changed) {
+        // A notified poll knows when the change was announced.
+        const uint32_t latency = static_cast<uint32_t>(now - (m_notifiedAt ? m_notifiedAt : m_lastPollAt));
+        ++m_stats.detections;
+        m_stats.latencyTotalMs += latency;
+        if (latency > m_stats.latencyMaxMs) m_stats.latencyMaxMs = latency;
+        m_lastChangeAt = now;
+    }
+    m_lastPollAt = now;
+    m_notifiedAt = 0;
+
+    const uint64_t quiet = now - m_lastChangeAt;
+    uint32_t next;
+    if (changed || quiet < m_cfg.holdFastMs) {
+        next = m_cfg.fastMs;
+    } else if (gameMinimized || quiet >= m_cfg.deepAfterMs) {
+        next = m_cfg.deepMs;
+    } else {
+        // Decay by half again per quiet poll: 100 -> 150 -> 225 -> ... -> steady
+        next = m_intervalMs + m_intervalMs / 2;
+        if (next > m_cfg.steadyMs) next = m_cfg.steadyMs;
+        if (next < m_cfg.fastMs) next = m_cfg.fastMs;
+    }
+    if (next != m_intervalMs) {
+        EFZDA_TRACE(Poll, Debug, "Scheduler: interval %ums -> %ums (%s)", (unsigned)m_intervalMs, (unsigned)next,
+            changed ? "change" : (gameMinimized ? "minimized" : (quiet >= m_cfg.deepAfterMs ? "idle" : "decay")));
+    }
+    m_intervalMs = next;
+    m_stats.intervalMs = next;
+
+    ++m_windowWakeups;
+    const uint64_t window = now - m_windowStart;
+    if (window >= 60000) {
+        m_stats.wakeupsPerMinute = static_cast<uint32_t>(m_windowWakeups * 60000ULL / window);
+        EFZDA_TRACE(Poll, Info, "Scheduler: %u wakeups/min, interval=%ums, detection latency avg=%ums max=%ums over %u changes, %u notified",
+            (unsigned)m_stats.wakeupsPerMinute, (unsigned)m_intervalMs,
+            (unsigned)(m_stats.detections ? m_stats.latencyTotalMs / m_stats.detections : 0),
+            (unsigned)m_stats.latencyMaxMs, (unsigned)m_stats.detections, (unsigned)m_stats.notifyWakeups);
+        m_windowStart = now;
+        m_windowWakeups = 0;
+    }
+}
+
+#ifdef _WIN32
+// Timer, wake and notify handles in one WaitForMultipleObjects.
+PollWake PollScheduler::wait() {
+    HANDLE handles[3];
+    DWORD count = 0;
+    bool timerArmed = false;
+    if (m_timer) {
+        LARGE_INTEGER due;
+        due.QuadPart = -static_cast<LONGLONG>(m_intervalMs) * 10000; // relative, 100 ns units
+        timerArmed = SetWaitableTimer(m_timer, &due, 0, nullptr, nullptr, FALSE) != FALSE;
+        if (timerArmed) handles[count++] = m_timer;
+    }
+    const DWORD wakeIndex = count;
+    if (m_wake) handles[count++] = reinterpret_cast<HANDLE>(m_wake->nativeHandle());
+    const DWORD notifyIndex = count;
+    if (m_notify && m_notify->isOpen()) handles[count++] = reinterpret_cast<HANDLE>(m_notify->nativeHandle());
+    if (count == 0) {
+        Sleep(m_intervalMs);
+        return PollWake::Timer;
+    }
+
+    const DWORD r = WaitForMultipleObjects(count, handles, FALSE, timerArmed ? INFINITE : m_intervalMs);
+    if (timerArmed) CancelWaitableTimer(m_timer);
+    if (m_wake && r == WAIT_OBJECT_0 + wakeIndex) return PollWake::Wake;
+    if (count <= notifyIndex || r != WAIT_OBJECT_0 + notifyIndex) return PollWake::Timer;
+    return notified();
+}
+#else
+// poll() on the wake and notify descriptors with the interval as timeout.
+PollWake PollScheduler::wait() {
+    pollfd fds[2];
+    nfds_t count = 0;
+    const nfds_t wakeIndex = count;
+    if (m_wake) fds[count++] = pollfd{static_cast<int>(m_wake->nativeHandle()), POLLIN, 0};
+    const nfds_t notifyIndex = count;
+    if (m_notify && m_notify->isOpen()) fds[count++] = pollfd{static_cast<int>(m_notify->nativeHandle()), POLLIN, 0};
+
+    const uint64_t due = now_ms() + m_intervalMs;
+    for (;;) {
+        const uint64_t now = now_ms();
+        if (now >= due) return PollWake::Timer;
+        const int r = ::poll(fds, count, static_cast<int>(due - now));
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return PollWake::Timer;
+        // Readiness does not consume the signal; wait(0) does.
+        if (count > wakeIndex && (fds[wakeIndex].revents & POLLIN) && m_wake->wait(0)) return PollWake::Wake;
+        if (count > notifyIndex && (fds[notifyIndex].revents & POLLIN) && m_notify->wait(0)) return notified();
+        // A descriptor in error or hung up stays ready without ever becoming
+        // readable; stop watching it for the rest of this wait (poll() skips
+        // negative fds) instead of spinning until the interval ends.
+        for (nfds_t i = 0; i < count; ++i) {
+            if ((fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) && !(fds[i].revents & POLLIN)) fds[i].fd = -1;
+        }
+    }
+}
+#endif
+
+// The notify source ended the wait.
+PollWake PollScheduler::notified() {
+    ++m_stats.notifyWakeups;
+    m_notifiedAt = now_ms();
+    // A notification right after a poll waits out the rest of the gap, so a
+    // burst of them costs one poll.
+    const uint64_t sinceLastPoll = m_notifiedAt - m_lastPollAt;
+    if (sinceLastPoll < m_cfg.notifyMinGapMs) {
+        const uint32_t rest = static_cast<uint32_t>(m_cfg.notifyMinGapMs - sinceLastPoll);
+        if (m_wake) {
+            m_wake->wait(rest);
+        } else {
+#ifdef _WIN32
+            Sleep(rest);
+#else
+            ::poll(nullptr, 0, static_cast<int>(rest));
+#endif
+        }
+    }
+    return PollWake::Notify;
+}
+
+void PollScheduler::wake() {
+    if (m_wake) m_wake->signal();
+}
+
+PollSchedulerStats PollScheduler::stats() const {
+    return m_stats;
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK find_game_window(HWND hwnd, LPARAM param) {
+    DWORD pid = 0;
+    GetWindowThreadProcessId(hwnd, &pid);
+    if (pid != GetCurrentProcessId() || GetWindow(hwnd, GW_OWNER) != nullptr || !IsWindowVisible(hwnd)) return TRUE;
+    *reinterpret_cast<HWND*>(param) = hwnd;
+    return FALSE;
+}
+
+bool game_window_minimized() {
+    static HWND s_window = nullptr;
+    if (!s_window || !IsWindow(s_window)) {
+        s_window = nullptr;
+        EnumWindows(find_game_window, reinterpret_cast<LPARAM>(&s_window));
+        if (!s_window) return false;
+    }
+    return IsIconic(s_window) != FALSE;
+}
+#else
+bool game_window_minimized() {
+    return false;
+}
+#endif
+
+} // namespace efzda
@@ -0,0 +1,143 @@
+#include "state/character_registry.h"
+
+#include <array>
+
+namespace efzda {
+
+namespace {
+
+constexpr CharacterInfo kCharacters[] = {
+    // raw       display            icon key                      large image key               netplay id
+    {"akane",    "Akane Satomura",  "90px-efz_akane_icon",        "90px-efz_akane_icon",        0xFF},
+    {"akiko",    "Akiko Minase",    "90px-efz_akiko_icon",        "90px-efz_akiko_icon",        0xFF},
+    {"ayu",      "Ayu Tsukimiya",   "90px-efz_ayu_icon",          "90px-efz_ayu_icon",          0xFF},
+    {"doppel",   "Doppel",          "90px-efz_doppel_icon",       "90px-efz_doppel_icon",       0xFF},
+    {"exnanase", "Doppel Nanase",   "90px-efz_doppel_icon",       "90px-efz_doppel_icon",       0xFF},
+    {"nanase",   "Rumi Nanase",     "90px-efz_rumi_icon",         "90px-efz_rumi_icon",         0xFF},
+    {"ikumi",    "Ikumi Amasawa",   "90px-efz_ikumi_icon",        "90px-efz_ikumi_icon",        0xFF},
+    {"kanna",    "Kanna",           "90px-efz_kanna_icon_-_copy", "90px-efz_kanna_icon_-_copy", 0xFF},
+    {"kano",     "Kano Kirishima",  "90px-efz_kano_icon",         "90px-efz_kano_icon",         0xFF},
+    {"kaori",    "Kaori Misaka",    "90px-efz_kaori_icon",        "90px-efz_kaori_icon",        0xFF},
+    {"mai",      "Mai Kawasumi",    "90px-efz_mai_icon",          "90px-efz_mai_icon",          0xFF},
+    {"makoto",   "Makoto Sawatari", "90px-efz_makoto_icon",       "90px-efz_makoto_icon",       0xFF},
+    {"mayu",     "Mayu Shiina",     "90px-efz_mayu_icon",         "90px-efz_mayu_icon",         0xFF},
+    {"minagi",   "Minagi Tohno",    "90px-efz_minagi_icon",       "90px-efz_minagi_icon",       0xFF},
+    {"mio",      "Mio Kouzuki",     "90px-efz_mio_icon",          "90px-efz_mio_icon",          0xFF},
+    {"misaki",   "Misaki Kawana",   "90px-efz_misaki_icon",       "90px-efz_misaki_icon",       0xFF},
+    {"mishio",   "Mishio Amano",    "90px-efz_mishio_icon",       "90px-efz_mishio_icon",       0xFF},
+    {"misuzu",   "Misuzu Kamio",    "90px-efz_misuzu_icon",       "90px-efz_misuzu_icon",       0xFF},
+    {"nagamori", "Mizuka Nagamori", "90px-efz_mizuka_icon",       "90px-efz_mizuka_icon",       0xFF},
+    {"nayuki",   "Nayuki(Sleepy)",  "90px-efz_neyuki_icon",       "90px-efz_neyuki_icon",       0xFF},
+    {"nayukib",  "Nayuki(Awake)",   "90px-efz_nayuki_icon",       "90px-efz_nayuki_icon",       0xFF},
+    // Boss (mizuka) and playable (mizukab) Unknown
+    {"mizuka",   "Unknown",         "90px-efz_unknown_icon",      "90px-efz_unknown_icon",      0xFF},
+    {"mizukab",  "Unknown",         "90px-efz_unknown_icon",      "90px-efz_unknown_icon",      0xFF},
+    {"sayuri",   "Sayuri Kurata",   "90px-efz_sayuri_icon",       "90px-efz_sayuri_icon",       0xFF},
+    {"shiori",   "Shiori Misaka",   "90px-efz_shiori_icon",       "90px-efz_shiori_icon",       0xFF},
+};
+constexpr size_t kCharacterCount = sizeof(kCharacters) / sizeof(kCharacters[0]);
+constexpr size_t kRawNameSize = 12;
+
+// The raw name as two little-endian words: bytes 0-7 and 8-11.
+struct RawKey {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+};
+
+constexpr RawKey raw_key(const char* s) {
+    RawKey k;
+    for (size_t i = 0; i < kRawNameSize && s[i]; ++i) {
+        const uint64_t b = static_cast<unsigned char>(s[i]);
+        if (i < 8) k.lo |= b << (8 * i);
+        else k.hi |= b << (8 * (i - 8));
+    }
+    return k;
+}
+
+constexpr unsigned kSlotBits = 6;
+constexpr size_t kSlots = size_t(1) << kSlotBits;
+static_assert(kCharacterCount < kSlots, "registry outgrew the hash table");
+static_assert(kCharacterCount < 0xFF, "CharacterId is one byte");
+
+constexpr unsigned slot_of(const RawKey& k, uint64_t seed) {
+    uint64_t x = k.lo ^ (k.hi * 0x9E3779B97F4A7C15ull) ^ seed;
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 29;
+    return static_cast<unsigned>(x >> (64 - kSlotBits));
+}
+
+// First seed under which every raw name lands in its own slot.
+constexpr uint64_t find_seed() {
+    for (uint64_t seed = 1; seed < 100000; ++seed) {
+        uint64_t used = 0;
+        bool ok = true;
+        for (size_t i = 0; i < kCharacterCount && ok; ++i) {
+            const uint64_t bit = uint64_t(1) << slot_of(raw_key(kCharacters[i].raw), seed);
+            ok = (used & bit) == 0;
+            used |= bit;
+        }
+        if (ok) return seed;
+    }
+    return 0;
+}
+
+constexpr uint64_t kSeed = find_seed();
+static_assert(kSeed != 0, "no perfect hash seed for the character registry");
+
+struct SlotTable {
+    std::array<uint8_t, kSlots> id{}; // CharacterId per slot, 0 = empty
+    std::array<RawKey, kSlots> key{};
+};
+
+constexpr SlotTable build_slots() {
+    SlotTable t;
+    for (size_t i = 0; i < kCharacterCount; ++i) {
+        const RawKey k = raw_key(kCharacters[i].raw);
+        const unsigned slot = slot_of(k, kSeed);
+        t.id[slot] = static_cast<uint8_t>(i + 1);
+        t.key[slot] = k;
+    }
+    return t;
+}
+
+constexpr SlotTable kSlotTable = build_slots();
+
+} // namespace
+
+CharacterId find_character(const char* raw, size_t size) {
+    if (!raw) return kNoCharacter;
+    // Same normalisation the old string path applied: stop at NUL, drop
+    // control characters, lower-case ASCII.
+    unsigned char buf[16] = {};
+    size_t n = 0;
+    for (size_t i = 0; i < size && i < kRawNameSize && raw[i]; ++i) {
+        unsigned char c = static_cast<unsigned char>(raw[i]);
+        if (c < 0x20 || c == 0x7F) continue;
+        if (c >= 'A' && c <= 'Z') c = static_cast<unsigned char>(c | 0x20);
+        buf[n++] = c;
+    }
+    RawKey k;
+    for (size_t i = 0; i < 8; ++i) k.lo |= uint64_t(buf[i]) << (8 * i);
+    for (size_t i = 0; i < 4; ++i) k.hi |= uint64_t(buf[8 + i]) << (8 * i);
+    const unsigned slot = slot_of(k, kSeed);
+    const uint8_t id = kSlotTable.id[slot];
+    if (id == 0 || kSlotTable.key[slot].lo != k.lo || kSlotTable.key[slot].hi != k.hi) return kNoCharacter;
+    return id;
+}
+
+const CharacterInfo* character_info(CharacterId id) {
+    if (id == kNoCharacter || id > kCharacterCount) return nullptr;
+    return &kCharacters[id - 1];
+}
+
+const char* character_display_name(CharacterId id) {
+    const CharacterInfo* info = character_info(id);
+    return info ? info->displayName : "";
+}
+
+size_t character_count() {
+    return kCharacterCount;
+}
+
+} // namespace efzda
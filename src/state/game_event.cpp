@@ -0,0 +1,20 @@
+#include "state/game_event.h"
+
+namespace efzda {
+
+const char* game_event_name(GameEventType type) {
+    switch (type) {
+        case GameEventType::ScreenChanged: return "ScreenChanged";
+        case GameEventType::CharacterLocked: return "CharacterLocked";
+        case GameEventType::MatchStarted: return "MatchStarted";
+        case GameEventType::MatchEnded: return "MatchEnded";
+        case GameEventType::RoundWon: return "RoundWon";
+        case GameEventType::SetEnded: return "SetEnded";
+        case GameEventType::NetplayPhaseChanged: return "NetplayPhaseChanged";
+        case GameEventType::NetplayFlowChanged: return "NetplayFlowChanged";
+        case GameEventType::SessionEnded: return "SessionEnded";
+    }
+    return "?";
+}
+
+} // namespace efzda
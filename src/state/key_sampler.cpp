@@ -0,0 +1,105 @@
+#include "state/key_sampler.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <chrono>
+
+#include "trace.h"
+
+namespace efzda {
+
+static uint64_t tick_ms() {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+KeySampler::~KeySampler() {
+    stop();
+}
+
+bool KeySampler::start(const KeySamplerConfig& cfg) {
+    if (running() || !cfg.p1Slot || !cfg.p2Slot) return false;
+    m_cfg = cfg;
+    if (m_cfg.intervalMs == 0) m_cfg.intervalMs = 1;
+    m_intervalMs.store(m_cfg.intervalMs, std::memory_order_relaxed);
+    m_stop.store(false, std::memory_order_relaxed);
+    try {
+        m_thread = std::thread(&KeySampler::run, this);
+    } catch (...) {
+        return false;
+    }
+    EFZDA_TRACE(Poll, Info, "KeySampler: started (interval=%ums budget=%uns)", (unsigned)m_cfg.intervalMs, (unsigned)m_cfg.budgetNs);
+    return true;
+}
+
+void KeySampler::stop() {
+    if (!m_thread.joinable()) return;
+    m_stop.store(true, std::memory_order_relaxed);
+    m_thread.join();
+}
+
+void KeySampler::setIdle(bool idle) {
+    if (m_idle.exchange(idle, std::memory_order_relaxed) != idle)
+        EFZDA_TRACE(Poll, Debug, "KeySampler: %s", idle ? "idle" : "active");
+}
+
+KeySamplerStats KeySampler::stats() const {
+    KeySamplerStats s;
+    s.samples = m_samples.load(std::memory_order_relaxed);
+    s.dropped = m_ring.dropped();
+    s.totalNs = m_totalNs.load(std::memory_order_relaxed);
+    s.maxNs = m_maxNs.load(std::memory_order_relaxed);
+    s.intervalMs = m_intervalMs.load(std::memory_order_relaxed);
+    s.backoffs = m_backoffs.load(std::memory_order_relaxed);
+    s.idle = m_idle.load(std::memory_order_relaxed);
+    return s;
+}
+
+void KeySampler::run() {
+    using Clock = std::chrono::steady_clock;
+    constexpr uint32_t kWindow = 64;
+    uint32_t intervalMs = m_cfg.intervalMs;
+    uint32_t windowCount = 0;
+    uint64_t windowNs = 0;
+    Clock::time_point next = Clock::now();
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        const Clock::time_point t0 = Clock::now();
+        KeySample k;
+        k.tick = tick_ms();
+        k.havePtrs = m_memory.read(m_cfg.p1Slot, &k.p1Ptr, sizeof(k.p1Ptr)) &&
+                     m_memory.read(m_cfg.p2Slot, &k.p2Ptr, sizeof(k.p2Ptr));
+        if (m_cfg.screenAddr) k.haveScreen = m_memory.read(m_cfg.screenAddr, &k.screen, sizeof(k.screen));
+        m_ring.tryPush(k);
+        const uint64_t ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+
+        m_samples.fetch_add(1, std::memory_order_relaxed);
+        m_totalNs.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > m_maxNs.load(std::memory_order_relaxed)) m_maxNs.store(ns, std::memory_order_relaxed);
+        windowNs += ns;
+        if (++windowCount == kWindow) {
+            if (windowNs / kWindow > m_cfg.budgetNs && intervalMs < kMaxIntervalMs) {
+                intervalMs = intervalMs * 2 > kMaxIntervalMs ? kMaxIntervalMs : intervalMs * 2;
+                m_intervalMs.store(intervalMs, std::memory_order_relaxed);
+                m_backoffs.fetch_add(1, std::memory_order_relaxed);
+                EFZDA_TRACE(Poll, Info, "KeySampler: avg %lluns over budget %uns; interval now %ums",
+                    (unsigned long long)(windowNs / kWindow), (unsigned)m_cfg.budgetNs, (unsigned)intervalMs);
+            }
+            windowCount = 0;
+            windowNs = 0;
+        }
+
+        const bool idle = m_idle.load(std::memory_order_relaxed);
+        next += std::chrono::milliseconds(idle ? kMaxIntervalMs : intervalMs);
+        const Clock::time_point now = Clock::now();
+        if (next < now) next = now; // overslept; don't burst to catch up
+        std::this_thread::sleep_until(next);
+    }
+}
+
+} // namespace efzda
@@ -0,0 +1,460 @@
+#include "state/netplay_export.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "trace.h"
+
+namespace efzda {
+
+namespace {
+
+// v2-v4 layout used before the menu ABI refresh in v6 (localNickname was 32
+// bytes and there was no menu detail byte).
+struct EFZNetplayStateCompatV4 {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t structSize;
+    uint32_t lastUpdateTick;
+    int32_t sessionMode;
+    int32_t sessionPhase;
+    int32_t localSide;
+    int32_t p1Wins;
+    int32_t p2Wins;
+    int32_t matchCounter;
+    char localNickname[32];
+    char p1Name[64];
+    char p2Name[64];
+    int32_t pingMs;
+    int32_t rollbackFrames;
+    uint8_t inNetplayMenu;
+    uint8_t netplayMenuScreen;
+    uint8_t pad0[2];
+    char revivalVersion[16];
+    uint8_t inNetplayCharacterSelect;
+    uint8_t inNetplayMatch;
+    uint8_t pad1[2];
+    uint32_t capabilityFlags;
+    uint32_t stateSeq;
+    uint32_t sessionId;
+    uint32_t setId;
+    uint8_t activityPhase;
+    uint8_t endReason;
+    uint8_t pad2[2];
+    uint8_t p1CharId;
+    uint8_t p2CharId;
+    uint8_t p1Locked;
+    uint8_t p2Locked;
+    uint8_t localCursorCharId;
+    uint8_t pad3[3];
+    uint8_t stageId;
+    uint8_t roundIndex;
+    uint8_t isRoundActive;
+    uint8_t pad4;
+    uint16_t roundTimerFrames;
+    uint8_t pad5[2];
+};
+
+// Legacy layout from NETPLAY_STATE_EXPORT.md before the lastUpdateTick field:
+// sessionMode directly follows the 12-byte header.
+struct EFZNetplayStateLegacyV1 {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t structSize;
+    int32_t sessionMode;
+    int32_t sessionPhase;
+    int32_t localSide;
+    int32_t p1Wins;
+    int32_t p2Wins;
+    int32_t matchCounter;
+    char localNickname[32];
+    char p1Name[64];
+    char p2Name[64];
+    int32_t pingMs;
+    int32_t rollbackFrames;
+    uint8_t inNetplayMenu;
+    uint8_t netplayMenuScreen;
+    char revivalVersion[16];
+};
+static_assert(offsetof(EFZNetplayStateLegacyV1, pingMs) == 196, "legacy v1 layout");
+static_assert(offsetof(EFZNetplayStateLegacyV1, revivalVersion) == 206, "legacy v1 layout");
+
+std::string sanitize_cstr(const char* p, size_t maxLen) {
+    if (!p || maxLen == 0) return {};
+    size_t len = 0;
+    while (len < maxLen && p[len] != '\0') ++len;
+    std::string s(p, p + len);
+    s.erase(std::remove_if(s.begin(), s.end(), [](unsigned char c) { return c < 0x20; }), s.end());
+    return s;
+}
+
+uint8_t normalize_legacy_menu_screen(uint8_t legacyScreen) {
+    switch (legacyScreen) {
+        case 0: return EFZ_MENU_MAIN;
+        case 1: return EFZ_MENU_HOST;
+        case 2: return EFZ_MENU_JOIN;
+        case 3: return EFZ_MENU_OPTIONS; // old Nickname menu
+        case 4: return EFZ_MENU_LOBBY;
+        default: return legacyScreen;
+    }
+}
+
+// ---- schema ----
+// A field copies `size` bytes at `offset` of the export into one member of
+// NetplayExportState. Fields are grouped; a group is decoded as a whole when
+// the struct is large enough to hold it and, for capability-gated groups,
+// its EFZ_CAP_* bit is set. Supporting a new ABI version means adding a
+// layout table below, not a parser.
+
+using StoreFn = void (*)(NetplayExportState& out, const unsigned char* src, size_t size);
+
+template <typename M> struct member_of;
+template <typename C, typename T> struct member_of<T C::*> { using type = T; };
+
+template <auto Member>
+void store(NetplayExportState& out, const unsigned char* src, size_t size) {
+    using T = typename member_of<decltype(Member)>::type;
+    (void)size;
+    if constexpr (std::is_same_v<T, std::string>) {
+        out.*Member = sanitize_cstr(reinterpret_cast<const char*>(src), size);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        out.*Member = src[0] != 0;
+    } else {
+        static_assert(std::is_integral_v<T>, "unsupported export field type");
+        // Scalar fields always fit whole; see build_plan().
+        T v;
+        std::memcpy(&v, src, sizeof(T));
+        out.*Member = v;
+    }
+}
+
+void store_legacy_menu_screen(NetplayExportState& out, const unsigned char* src, size_t) {
+    out.netplayMenuScreen = normalize_legacy_menu_screen(src[0]);
+}
+
+struct ExportField {
+    uint16_t offset;
+    uint16_t size;
+    uint8_t group;
+    bool text;   // char array, decoded as a sanitized string
+    StoreFn store;
+};
+
+struct ExportGroup {
+    uint32_t capBit;                        // 0: decoded whenever it fits
+    bool NetplayExportState::* flag;        // set when the group is decoded
+};
+
+// Groups shared by every layout, in decode order. capabilityFlags precedes
+// the groups gated on it.
+enum : uint8_t {
+    G_BASE = 0,     // lastUpdateTick .. rollbackFrames; required
+    G_MENU_OPEN,
+    G_MENU_SCREEN,
+    G_MENU_DETAIL,
+    G_REVIVAL,
+    G_CHARSELECT_FLAG,
+    G_MATCH_FLAG,
+    G_CAPS,
+    G_SEQ,
+    G_SESSION_ID,
+    G_SET_ID,
+    G_ACTIVITY,
+    G_END_REASON,
+    G_CHARSELECT,
+    G_MATCH,
+    G_ASYNC_HOST,
+    G_NET_DETAIL,
+    G_CONNECTION,
+    kGroupCount
+};
+
+constexpr ExportGroup kGroups[kGroupCount] = {
+    {0, nullptr},
+    {0, nullptr},
+    {0, nullptr},
+    {0, nullptr},
+    {0, nullptr},
+    {0, nullptr},
+    {0, nullptr},
+    {0, &NetplayExportState::hasCapabilityFlags},
+    {0, nullptr},
+    {0, nullptr},
+    {0, nullptr},
+    {0, &NetplayExportState::hasActivityPhase},
+    {0, &NetplayExportState::hasEndReason},
+    {0, &NetplayExportState::hasCharSelectContext},
+    {0, &NetplayExportState::hasMatchContext},
+    // v7 groups: the writer drops the bit on ticks where the data is unavailable.
+    {EFZ_CAP_ASYNC_HOST, &NetplayExportState::hasAsyncHost},
+    {EFZ_CAP_NET_DETAIL, &NetplayExportState::hasNetDetail},
+    {EFZ_CAP_CONNECTION, &NetplayExportState::hasConnection},
+};
+
+// Source field type Src (from the layout struct) into Member. Scalars must
+// match the member's width; char arrays decode into std::string members.
+template <auto Member, typename Src>
+constexpr ExportField export_field(size_t offset, uint8_t group) {
+    using T = typename member_of<decltype(Member)>::type;
+    constexpr bool text = std::is_array_v<Src>;
+    static_assert(text == std::is_same_v<T, std::string>, "char arrays decode into strings");
+    static_assert(text || sizeof(Src) == sizeof(T), "scalar field width mismatch");
+    return ExportField{static_cast<uint16_t>(offset), static_cast<uint16_t>(sizeof(Src)), group, text, &store<Member>};
+}
+
+#define EFZDA_EXPORT_FIELD(Layout, group, field, member) \
+    export_field<&NetplayExportState::member, decltype(Layout::field)>(offsetof(Layout, field), group)
+#define EFZDA_EXPORT_FIELD_FN(Layout, group, field, fn) \
+    ExportField{ offsetof(Layout, field), sizeof(Layout::field), group, false, fn }
+
+#define F(group, field) EFZDA_EXPORT_FIELD(EFZNetplayState, group, field, field)
+constexpr ExportField kFieldsV6[] = {
+    F(G_BASE, lastUpdateTick),
+    F(G_BASE, sessionMode),
+    F(G_BASE, sessionPhase),
+    F(G_BASE, localSide),
+    F(G_BASE, p1Wins),
+    F(G_BASE, p2Wins),
+    F(G_BASE, matchCounter),
+    F(G_BASE, localNickname),
+    F(G_BASE, p1Name),
+    F(G_BASE, p2Name),
+    F(G_BASE, pingMs),
+    F(G_BASE, rollbackFrames),
+    F(G_MENU_OPEN, inNetplayMenu),
+    F(G_MENU_SCREEN, netplayMenuScreen),
+    F(G_MENU_DETAIL, netplayMenuDetail),
+    F(G_REVIVAL, revivalVersion),
+    F(G_CHARSELECT_FLAG, inNetplayCharacterSelect),
+    F(G_MATCH_FLAG, inNetplayMatch),
+    F(G_CAPS, capabilityFlags),
+    F(G_SEQ, stateSeq),
+    F(G_SESSION_ID, sessionId),
+    F(G_SET_ID, setId),
+    F(G_ACTIVITY, activityPhase),
+    F(G_END_REASON, endReason),
+    F(G_CHARSELECT, p1CharId),
+    F(G_CHARSELECT, p2CharId),
+    F(G_CHARSELECT, p1Locked),
+    F(G_CHARSELECT, p2Locked),
+    F(G_CHARSELECT, localCursorCharId),
+    F(G_MATCH, stageId),
+    F(G_MATCH, roundIndex),
+    F(G_MATCH, isRoundActive),
+    F(G_MATCH, roundTimerFrames),
+    F(G_ASYNC_HOST, asyncHostActive),
+    F(G_ASYNC_HOST, asyncHostMinimized),
+    F(G_ASYNC_HOST, asyncHostPeerFound),
+    F(G_ASYNC_HOST, asyncHostTimedOut),
+    F(G_ASYNC_HOST, hostPort),
+    F(G_NET_DETAIL, avgPingMs),
+    F(G_NET_DETAIL, minPingMs),
+    F(G_NET_DETAIL, maxPingMs),
+    F(G_NET_DETAIL, recommendedDelay),
+    F(G_NET_DETAIL, minDelay),
+    F(G_NET_DETAIL, maxDelay),
+    F(G_CONNECTION, connectionAddress),
+};
+#undef F
+
+#define F(group, field) EFZDA_EXPORT_FIELD(EFZNetplayStateCompatV4, group, field, field)
+constexpr ExportField kFieldsV4[] = {
+    F(G_BASE, lastUpdateTick),
+    F(G_BASE, sessionMode),
+    F(G_BASE, sessionPhase),
+    F(G_BASE, localSide),
+    F(G_BASE, p1Wins),
+    F(G_BASE, p2Wins),
+    F(G_BASE, matchCounter),
+    F(G_BASE, localNickname),
+    F(G_BASE, p1Name),
+    F(G_BASE, p2Name),
+    F(G_BASE, pingMs),
+    F(G_BASE, rollbackFrames),
+    F(G_MENU_OPEN, inNetplayMenu),
+    EFZDA_EXPORT_FIELD_FN(EFZNetplayStateCompatV4, G_MENU_SCREEN, netplayMenuScreen, &store_legacy_menu_screen),
+    F(G_REVIVAL, revivalVersion),
+    F(G_CHARSELECT_FLAG, inNetplayCharacterSelect),
+    F(G_MATCH_FLAG, inNetplayMatch),
+    F(G_CAPS, capabilityFlags),
+    F(G_SEQ, stateSeq),
+    F(G_SESSION_ID, sessionId),
+    F(G_SET_ID, setId),
+    F(G_ACTIVITY, activityPhase),
+    F(G_END_REASON, endReason),
+    F(G_CHARSELECT, p1CharId),
+    F(G_CHARSELECT, p2CharId),
+    F(G_CHARSELECT, p1Locked),
+    F(G_CHARSELECT, p2Locked),
+    F(G_CHARSELECT, localCursorCharId),
+    F(G_MATCH, stageId),
+    F(G_MATCH, roundIndex),
+    F(G_MATCH, isRoundActive),
+    F(G_MATCH, roundTimerFrames),
+};
+#undef F
+
+#define F(group, field) EFZDA_EXPORT_FIELD(EFZNetplayStateLegacyV1, group, field, field)
+constexpr ExportField kFieldsV1[] = {
+    F(G_BASE, sessionMode),
+    F(G_BASE, sessionPhase),
+    F(G_BASE, localSide),
+    F(G_BASE, p1Wins),
+    F(G_BASE, p2Wins),
+    F(G_BASE, matchCounter),
+    F(G_BASE, localNickname),
+    F(G_BASE, p1Name),
+    F(G_BASE, p2Name),
+    F(G_BASE, pingMs),
+    F(G_BASE, rollbackFrames),
+    F(G_MENU_OPEN, inNetplayMenu),
+    EFZDA_EXPORT_FIELD_FN(EFZNetplayStateLegacyV1, G_MENU_SCREEN, netplayMenuScreen, &store_legacy_menu_screen),
+    F(G_REVIVAL, revivalVersion),
+};
+#undef F
+#undef EFZDA_EXPORT_FIELD_FN
+#undef EFZDA_EXPORT_FIELD
+
+struct ExportLayout {
+    const char* name;
+    uint32_t minVersion;
+    uint32_t maxVersion;
+    const ExportField* fields;
+    size_t fieldCount;
+    bool clipText; // strings only need their first byte inside the struct
+};
+
+constexpr size_t kNoOffset = static_cast<size_t>(-1);
+constexpr size_t kMaxFields = 64;
+
+// Tried in order; the first whose version range matches and whose base group
+// fits is used. v6 changed the layout in place (larger localNickname, menu
+// detail byte), v7 only appended capability-gated groups.
+constexpr ExportLayout kLayouts[] = {
+    {"v6", 6, 0xFFFFFFFFu, kFieldsV6, sizeof(kFieldsV6) / sizeof(kFieldsV6[0]), false},
+    {"v2-v4", 0, 5, kFieldsV4, sizeof(kFieldsV4) / sizeof(kFieldsV4[0]), false},
+    {"v1", 0, 0xFFFFFFFFu, kFieldsV1, sizeof(kFieldsV1) / sizeof(kFieldsV1[0]), true},
+};
+
+// One field of a plan, with its size already clipped to the struct.
+struct ExportStep {
+    StoreFn store;
+    uint16_t offset;
+    uint16_t size;
+    uint32_t capBit;
+    uint32_t groupBit;
+};
+
+// Decode plan for one (version, structSize) pair: the layout and the fields
+// of every group that fits. Only capability bits are checked at decode time.
+struct ExportPlan {
+    uint32_t version = 0;
+    uint32_t structSize = 0;
+    const ExportLayout* layout = nullptr;
+    uint32_t groups = 0; // bit per group
+    size_t seqOffset = kNoOffset;
+    ExportStep steps[kMaxFields] = {};
+    size_t stepCount = 0;
+};
+static_assert(kGroupCount <= 32, "group mask is 32 bits");
+
+size_t field_end(const ExportLayout& layout, const ExportField& f) {
+    return layout.clipText && f.text ? f.offset + 1u : f.offset + static_cast<size_t>(f.size);
+}
+
+ExportPlan build_plan(uint32_t version, uint32_t structSize) {
+    ExportPlan plan;
+    plan.version = version;
+    plan.structSize = structSize;
+    for (const ExportLayout& layout : kLayouts) {
+        if (version < layout.minVersion || version > layout.maxVersion) continue;
+        size_t groupEnd[kGroupCount] = {};
+        uint32_t present = 0;
+        for (size_t i = 0; i < layout.fieldCount; ++i) {
+            const ExportField& f = layout.fields[i];
+            groupEnd[f.group] = (std::max)(groupEnd[f.group], field_end(layout, f));
+            present |= 1u << f.group;
+        }
+        if (groupEnd[G_BASE] > structSize) continue;
+        for (unsigned g = 0; g < kGroupCount; ++g) {
+            if ((present & (1u << g)) && groupEnd[g] <= structSize) plan.groups |= 1u << g;
+        }
+        plan.layout = &layout;
+        EFZDA_TRACE(Netplay, Debug, "Netplay export: v%u size=%u decodes as layout %s (groups=0x%05X)",
+            (unsigned)version, (unsigned)structSize, layout.name, (unsigned)plan.groups);
+        for (size_t i = 0; i < layout.fieldCount; ++i) {
+            const ExportField& f = layout.fields[i];
+            if (!(plan.groups & (1u << f.group))) continue;
+            ExportStep& step = plan.steps[plan.stepCount++];
+            step.store = f.store;
+            step.offset = f.offset;
+            step.size = static_cast<uint16_t>((std::min)(static_cast<size_t>(f.size), structSize - static_cast<size_t>(f.offset)));
+            step.capBit = kGroups[f.group].capBit;
+            step.groupBit = 1u << f.group;
+            if (f.group == G_SEQ) plan.seqOffset = f.offset;
+        }
+        break;
+    }
+    return plan;
+}
+
+// The export's header does not change within a session, so a couple of
+// cached plans cover every read. Poll thread only.
+const ExportPlan& plan_for(uint32_t version, uint32_t structSize) {
+    static ExportPlan s_plans[4];
+    static unsigned s_next = 0;
+    for (const ExportPlan& p : s_plans) {
+        if (p.structSize == structSize && p.version == version && p.structSize != 0) return p;
+    }
+    ExportPlan& slot = s_plans[s_next];
+    s_next = (s_next + 1) % (sizeof(s_plans) / sizeof(s_plans[0]));
+    slot = build_plan(version, structSize);
+    return slot;
+}
+
+bool read_header(const unsigned char* base, uint32_t& version, uint32_t& structSize) {
+    uint32_t magic = 0;
+    std::memcpy(&magic, base, sizeof(magic));
+    std::memcpy(&version, base + 4, sizeof(version));
+    std::memcpy(&structSize, base + 8, sizeof(structSize));
+    return magic == EFZ_NETPLAY_STATE_MAGIC && structSize >= EFZ_NETPLAY_STATE_LEGACY_MIN_V1_SIZE && structSize <= 4096;
+}
+
+} // namespace
+
+bool parse_netplay_export_state(const void* block, NetplayExportState& out) {
+    out = NetplayExportState{};
+    if (!block) return false;
+    const unsigned char* base = static_cast<const unsigned char*>(block);
+    uint32_t version = 0, structSize = 0;
+    if (!read_header(base, version, structSize)) return false;
+    const ExportPlan& plan = plan_for(version, structSize);
+    if (!plan.layout) return false;
+
+    out.version = version;
+    out.structSize = structSize;
+    uint32_t decoded = 0;
+    for (size_t i = 0; i < plan.stepCount; ++i) {
+        const ExportStep& step = plan.steps[i];
+        if (step.capBit && (out.capabilityFlags & step.capBit) == 0) continue;
+        step.store(out, base + step.offset, step.size);
+        decoded |= step.groupBit;
+    }
+    for (unsigned g = 0; g < kGroupCount; ++g) {
+        if ((decoded & (1u << g)) && kGroups[g].flag) out.*(kGroups[g].flag) = true;
+    }
+    if (out.hasConnection && out.connectionAddress.empty()) out.hasConnection = false;
+    out.valid = true;
+    return true;
+}
+
+bool netplay_export_seq_offset(uint32_t version, uint32_t structSize, size_t& offset) {
+    if (structSize < EFZ_NETPLAY_STATE_LEGACY_MIN_V1_SIZE || structSize > 4096) return false;
+    const ExportPlan& plan = plan_for(version, structSize);
+    if (!plan.layout || plan.seqOffset == kNoOffset) return false;
+    offset = plan.seqOffset;
+    return true;
+}
+
+} // namespace efzda
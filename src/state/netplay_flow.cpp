@@ -0,0 +1,192 @@
+#include "state/netplay_flow.h"
+
+#include <array>
+
+namespace efzda {
+
+uint16_t netplay_flow_key(const NetplayFlowInputs& in) {
+    return static_cast<uint16_t>(
+        (static_cast<unsigned>(in.claim) & 0xFu) |
+        (in.claimConflict ? 1u << 4 : 0u) |
+        (in.activityPhase ? 1u << 5 : 0u) |
+        (in.sessionActive ? 1u << 6 : 0u) |
+        (in.connected ? 1u << 7 : 0u) |
+        (in.exportStale ? 1u << 8 : 0u) |
+        (in.idleNoFlow ? 1u << 9 : 0u) |
+        ((static_cast<unsigned>(in.titleScreen) & 3u) << 10) |
+        ((static_cast<unsigned>(in.localScreen) & 3u) << 12) |
+        (in.live ? 1u << 14 : 0u) |
+        (in.vsFlow ? 1u << 15 : 0u));
+}
+
+NetplayFlowInputs netplay_flow_inputs(uint16_t key) {
+    NetplayFlowInputs in;
+    in.claim = static_cast<NetplayFlow>(key & 0xFu);
+    in.claimConflict = (key >> 4) & 1u;
+    in.activityPhase = (key >> 5) & 1u;
+    in.sessionActive = (key >> 6) & 1u;
+    in.connected = (key >> 7) & 1u;
+    in.exportStale = (key >> 8) & 1u;
+    in.idleNoFlow = (key >> 9) & 1u;
+    in.titleScreen = static_cast<FlowTitleScreen>((key >> 10) & 3u);
+    in.localScreen = static_cast<FlowLocalScreen>((key >> 12) & 3u);
+    in.live = (key >> 14) & 1u;
+    in.vsFlow = (key >> 15) & 1u;
+    return in;
+}
+
+// Local evidence for where a stale menu claim really is.
+static NetplayFlow map_local_flow(const NetplayFlowInputs& in) {
+    if (in.titleScreen != FlowTitleScreen::NoScreen) {
+        switch (in.localScreen) {
+            case FlowLocalScreen::CharSelect: return NetplayFlow::CharSelect;
+            case FlowLocalScreen::Loading: return NetplayFlow::Loading;
+            case FlowLocalScreen::InGame: return NetplayFlow::Match;
+            default: break;
+        }
+    }
+    if (in.live) return NetplayFlow::Match;
+    if (in.sessionActive && in.vsFlow) return NetplayFlow::CharSelect;
+    return NetplayFlow::None;
+}
+
+NetplayFlowDecision evaluate_netplay_flow_rules(const NetplayFlowInputs& in) {
+    NetplayFlowDecision d;
+    if (static_cast<unsigned>(in.claim) >= kNetplayFlowCount) return d;
+    d.flow = in.claim;
+    if (in.claimConflict && d.flow != NetplayFlow::None) {
+        d.rule = NetplayFlowRule::ExplicitFlags;
+    }
+
+    // The menu overlay lives on the title screen only; each rule below
+    // replaces a menu claim the local game state contradicts.
+    auto overrideMenu = [&](NetplayFlowRule mapped, NetplayFlowRule loading, NetplayFlowRule dropped) {
+        d.flow = map_local_flow(in);
+        d.rule = mapped;
+        if (d.flow == NetplayFlow::None) {
+            d.flow = in.connected ? NetplayFlow::Loading : NetplayFlow::None;
+            d.rule = in.connected ? loading : dropped;
+        }
+    };
+    const bool screenNotTitle =
+        in.titleScreen == FlowTitleScreen::Unknown || in.titleScreen == FlowTitleScreen::NotTitle;
+    const bool gameplayLike = in.live || screenNotTitle;
+
+    if (d.flow == NetplayFlow::Menu && in.sessionActive &&
+        (in.titleScreen == FlowTitleScreen::NotTitle || (in.connected && in.vsFlow))) {
+        overrideMenu(NetplayFlowRule::HardOverride, NetplayFlowRule::HardOverrideLoading, NetplayFlowRule::HardOverrideDropped);
+    }
+    if (d.flow == NetplayFlow::Menu && gameplayLike && (in.connected || in.exportStale)) {
+        overrideMenu(NetplayFlowRule::LocalContext, NetplayFlowRule::LocalContextLoading, NetplayFlowRule::LocalContextDropped);
+    }
+    if (!in.activityPhase) {
+        if (d.flow == NetplayFlow::Menu && screenNotTitle) {
+            d.flow = NetplayFlow::None;
+            d.rule = NetplayFlowRule::NotTitle;
+        }
+        if (d.flow == NetplayFlow::Menu && in.connected && gameplayLike) {
+            d.flow = NetplayFlow::None;
+            d.rule = NetplayFlowRule::ConnectedGameplay;
+        }
+    }
+    if (in.idleNoFlow) {
+        d.flow = NetplayFlow::None;
+        d.rule = NetplayFlowRule::IdleNoFlow;
+    }
+    return d;
+}
+
+// Entry: flow in the low nibble, rule in the high nibble.
+static const std::array<uint8_t, kNetplayFlowKeyCount>& flow_table() {
+    static const std::array<uint8_t, kNetplayFlowKeyCount> s_table = [] {
+        std::array<uint8_t, kNetplayFlowKeyCount> t{};
+        for (unsigned key = 0; key < kNetplayFlowKeyCount; ++key) {
+            const NetplayFlowDecision d = evaluate_netplay_flow_rules(netplay_flow_inputs(static_cast<uint16_t>(key)));
+            t[key] = static_cast<uint8_t>(static_cast<unsigned>(d.flow) | (static_cast<unsigned>(d.rule) << 4));
+        }
+        return t;
+    }();
+    return s_table;
+}
+
+NetplayFlowDecision resolve_netplay_flow(const NetplayFlowInputs& in) {
+    const uint8_t e = flow_table()[netplay_flow_key(in)];
+    NetplayFlowDecision d;
+    d.flow = static_cast<NetplayFlow>(e & 0xFu);
+    d.rule = static_cast<NetplayFlowRule>(e >> 4);
+    return d;
+}
+
+const char* netplay_flow_name(NetplayFlow flow) {
+    switch (flow) {
+        case NetplayFlow::None: return "None";
+        case NetplayFlow::Menu: return "Menu";
+        case NetplayFlow::Connecting: return "Connecting";
+        case NetplayFlow::DelaySetup: return "DelaySetup";
+        case NetplayFlow::CharSelect: return "CharSelect";
+        case NetplayFlow::Loading: return "Loading";
+        case NetplayFlow::Match: return "Match";
+        case NetplayFlow::Results: return "Results";
+        case NetplayFlow::HostIdle: return "HostIdle";
+    }
+    return "?";
+}
+
+const char* netplay_flow_rule_name(NetplayFlowRule rule) {
+    switch (rule) {
+        case NetplayFlowRule::Claimed: return "Claimed";
+        case NetplayFlowRule::ExplicitFlags: return "ExplicitFlags";
+        case NetplayFlowRule::HardOverride: return "HardOverride";
+        case NetplayFlowRule::HardOverrideLoading: return "HardOverrideLoading";
+        case NetplayFlowRule::HardOverrideDropped: return "HardOverrideDropped";
+        case NetplayFlowRule::LocalContext: return "LocalContext";
+        case NetplayFlowRule::LocalContextLoading: return "LocalContextLoading";
+        case NetplayFlowRule::LocalContextDropped: return "LocalContextDropped";
+        case NetplayFlowRule::NotTitle: return "NotTitle";
+        case NetplayFlowRule::ConnectedGameplay: return "ConnectedGameplay";
+        case NetplayFlowRule::IdleNoFlow: return "IdleNoFlow";
+    }
+    return "?";
+}
+
+static const char* title_screen_name(FlowTitleScreen t) {
+    switch (t) {
+        case FlowTitleScreen::NoScreen: return "none";
+        case FlowTitleScreen::Unknown: return "unknown";
+        case FlowTitleScreen::Title: return "title";
+        case FlowTitleScreen::NotTitle: return "other";
+    }
+    return "?";
+}
+
+static const char* local_screen_name(FlowLocalScreen l) {
+    switch (l) {
+        case FlowLocalScreen::Other: return "other";
+        case FlowLocalScreen::CharSelect: return "charsel";
+        case FlowLocalScreen::Loading: return "loading";
+        case FlowLocalScreen::InGame: return "ingame";
+    }
+    return "?";
+}
+
+size_t write_netplay_flow_table(std::FILE* out) {
+    if (!out) return 0;
+    std::fputs("key,claim,conflict,activity,session,connected,stale,idleNoFlow,title,screen,live,vs,flow,rule\n", out);
+    size_t rows = 0;
+    for (unsigned key = 0; key < kNetplayFlowKeyCount; ++key) {
+        const NetplayFlowInputs in = netplay_flow_inputs(static_cast<uint16_t>(key));
+        if (static_cast<unsigned>(in.claim) >= kNetplayFlowCount) continue;
+        const NetplayFlowDecision d = resolve_netplay_flow(in);
+        std::fprintf(out, "0x%04X,%s,%d,%d,%d,%d,%d,%d,%s,%s,%d,%d,%s,%s\n",
+            key, netplay_flow_name(in.claim),
+            in.claimConflict ? 1 : 0, in.activityPhase ? 1 : 0, in.sessionActive ? 1 : 0,
+            in.connected ? 1 : 0, in.exportStale ? 1 : 0, in.idleNoFlow ? 1 : 0,
+            title_screen_name(in.titleScreen), local_screen_name(in.localScreen),
+            in.live ? 1 : 0, in.vsFlow ? 1 : 0,
+            netplay_flow_name(d.flow), netplay_flow_rule_name(d.rule));
+        ++rows;
+    }
+    return rows;
+}
+
+} // namespace efzda
@@ -0,0 +1,46 @@
+#include "state/netplay_history.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace efzda {
+
+static const char kHistoryMagic[8] = {'E', 'F', 'Z', 'H', 'I', 'S', 'T', '\0'};
+
+void NetplayHistory::push(const NetplayHistoryRecord& record) {
+    m_records[m_next] = record;
+    m_next = (m_next + 1) % kCapacity;
+    if (m_count < kCapacity) ++m_count;
+}
+
+bool NetplayHistory::dump(const SnapshotPath& path, const char* reason, uint64_t tick) const {
+#ifdef _WIN32
+    std::FILE* f = _wfopen(path.c_str(), L"ab");
+#else
+    std::FILE* f = std::fopen(path.c_str(), "ab");
+#endif
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    if (std::ftell(f) >= kMaxFileBytes) {
+        std::fclose(f);
+        return false;
+    }
+    NetplayHistoryDumpHeader h{};
+    std::memcpy(h.magic, kHistoryMagic, sizeof(h.magic));
+    h.version = kNetplayHistoryFormatVersion;
+    h.headerSize = sizeof(NetplayHistoryDumpHeader);
+    h.recordSize = sizeof(NetplayHistoryRecord);
+    h.count = static_cast<uint32_t>(m_count);
+    h.tick = tick;
+    for (size_t i = 0; reason && reason[i] && i + 1 < sizeof(h.reason); ++i) h.reason[i] = reason[i];
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+    // Oldest first: the ring wraps at m_next once it is full.
+    const size_t first = m_count < kCapacity ? 0 : m_next;
+    const size_t head = m_count < kCapacity ? m_count : kCapacity - first;
+    if (ok && head) ok = std::fwrite(&m_records[first], sizeof(NetplayHistoryRecord), head, f) == head;
+    if (ok && m_count - head) ok = std::fwrite(&m_records[0], sizeof(NetplayHistoryRecord), m_count - head, f) == m_count - head;
+    ok = std::fclose(f) == 0 && ok;
+    return ok;
+}
+
+} // namespace efzda
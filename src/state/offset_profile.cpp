@@ -0,0 +1,160 @@
+#include "state/offset_profile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+namespace efzda {
+
+namespace {
+
+struct OffsetField {
+    const char* key;        // efz_offsets.txt key
+    const wchar_t* envName; // environment override, nullptr = file only
+    uintptr_t OffsetProfile::*member;
+    uintptr_t limit;        // values must be in (0, limit)
+};
+
+constexpr uintptr_t kRvaLimit = 0x1000000;
+constexpr uintptr_t kOffsetLimit = 0x10000;
+
+const OffsetField kFields[] = {
+    {"wins_base_rva", L"EFZDA_WINS_BASE_RVA", &OffsetProfile::winsBaseRva, kRvaLimit},
+    {"online_state_rva", L"EFZDA_ONLINE_STATE_RVA", &OffsetProfile::onlineStateRva, kRvaLimit},
+    {"online_state_ptr_rva", L"EFZDA_ONLINE_STATE_PTR_RVA", &OffsetProfile::onlineStatePtrRva, kRvaLimit},
+    {"online_state_offset", L"EFZDA_ONLINE_STATE_OFFSET", &OffsetProfile::onlineStateOffset, kOffsetLimit},
+    {"online_state_offset_alt", nullptr, &OffsetProfile::onlineStateOffsetAlt, kOffsetLimit},
+    {"current_player_offset", L"EFZDA_CURRENT_PLAYER_OFFSET", &OffsetProfile::currentPlayerOffset, kOffsetLimit},
+    {"net_p1_win_offset", L"EFZDA_NET_P1_WIN_OFFSET", &OffsetProfile::netP1WinOffset, kOffsetLimit},
+    {"net_p2_win_offset", L"EFZDA_NET_P2_WIN_OFFSET", &OffsetProfile::netP2WinOffset, kOffsetLimit},
+    {"tourn_p1_win_offset", L"EFZDA_TOURN_P1_WIN_OFFSET", &OffsetProfile::tournP1WinOffset, kOffsetLimit},
+    {"tourn_p2_win_offset", L"EFZDA_TOURN_P2_WIN_OFFSET", &OffsetProfile::tournP2WinOffset, kOffsetLimit},
+    {"nick_p1_offset", L"EFZDA_P1_NICK_OFFSET", &OffsetProfile::nickP1Offset, kOffsetLimit},
+    {"nick_p2_offset", L"EFZDA_P2_NICK_OFFSET", &OffsetProfile::nickP2Offset, kOffsetLimit},
+};
+
+std::string trim(const std::string& s) {
+    const auto start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    const auto end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+const OffsetField* find_field(const std::string& key) {
+    for (const auto& f : kFields)
+        if (key == f.key) return &f;
+    return nullptr;
+}
+
+} // namespace
+
+// One pass over `text` applying the [section] blocks named `wanted`.
+static size_t apply_section(const std::string& text, const std::string& wanted, OffsetProfile& profile,
+                            std::vector<std::string>* warnings, bool reportHeaders) {
+    auto warn = [&](size_t lineNo, const std::string& msg) {
+        if (warnings) warnings->push_back("line " + std::to_string(lineNo) + ": " + msg);
+    };
+    size_t applied = 0;
+    bool active = false;
+    size_t lineNo = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos) eol = text.size();
+        std::string line = text.substr(pos, eol - pos);
+        pos = eol + 1;
+        ++lineNo;
+
+        const size_t comment = line.find_first_of("#;");
+        if (comment != std::string::npos) line.resize(comment);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        if (line.front() == '[') {
+            if (line.back() != ']') {
+                if (reportHeaders) warn(lineNo, "unterminated section header");
+                active = false;
+                continue;
+            }
+            active = lower(trim(line.substr(1, line.size() - 2))) == wanted;
+            continue;
+        }
+        if (!active) continue;
+
+        const size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            warn(lineNo, "expected key = value");
+            continue;
+        }
+        const std::string key = lower(trim(line.substr(0, eq)));
+        const std::string value = trim(line.substr(eq + 1));
+        const OffsetField* field = find_field(key);
+        if (!field) {
+            warn(lineNo, "unknown key '" + key + "'");
+            continue;
+        }
+        char* end = nullptr;
+        const unsigned long long v = std::strtoull(value.c_str(), &end, 0);
+        if (value.empty() || (end && *end) || v == 0 || v >= field->limit) {
+            warn(lineNo, "bad value '" + value + "' for " + key);
+            continue;
+        }
+        profile.*(field->member) = static_cast<uintptr_t>(v);
+        ++applied;
+    }
+    return applied;
+}
+
+size_t apply_offsets_text(const std::string& text, const std::vector<std::string>& sections,
+                          OffsetProfile& profile, std::vector<std::string>* warnings) {
+    size_t applied = 0;
+    for (size_t i = 0; i < sections.size(); ++i)
+        applied += apply_section(text, lower(sections[i]), profile, warnings, i == 0);
+    profile.fileValues += applied;
+    return applied;
+}
+
+#ifdef _WIN32
+
+size_t apply_offsets_file(const std::wstring& path, const std::vector<std::string>& sections,
+                          OffsetProfile& profile, std::vector<std::string>* warnings) {
+    std::FILE* f = _wfopen(path.c_str(), L"r");
+    if (!f) return 0;
+    std::string text;
+    char buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+    std::fclose(f);
+    return apply_offsets_text(text, sections, profile, warnings);
+}
+
+size_t apply_offset_env_overrides(OffsetProfile& profile) {
+    size_t applied = 0;
+    for (const auto& f : kFields) {
+        if (!f.envName) continue;
+        wchar_t buf[32];
+        const DWORD n = GetEnvironmentVariableW(f.envName, buf, _countof(buf));
+        if (n == 0 || n >= _countof(buf)) continue;
+        wchar_t* end = nullptr;
+        const unsigned long v = wcstoul(buf, &end, 0);
+        if (v > 0 && v < f.limit) {
+            profile.*(f.member) = static_cast<uintptr_t>(v);
+            ++applied;
+        }
+    }
+    profile.envValues += applied;
+    return applied;
+}
+
+#endif
+
+} // namespace efzda
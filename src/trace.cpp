@@ -0,0 +1,100 @@
+#include "trace.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <cwctype>
+#else
+#include <cctype>
+#include <cstdlib>
+#endif
+#include <string>
+
+namespace efzda {
+
+namespace trace_detail {
+std::atomic<uint32_t> g_mask{(1u << kTraceCategoryCount) - 1};
+std::atomic<uint8_t> g_levels[kTraceCategoryCount] = {
+    {static_cast<uint8_t>(TraceLevel::Verbose)}, {static_cast<uint8_t>(TraceLevel::Verbose)},
+    {static_cast<uint8_t>(TraceLevel::Verbose)}, {static_cast<uint8_t>(TraceLevel::Verbose)},
+    {static_cast<uint8_t>(TraceLevel::Verbose)}, {static_cast<uint8_t>(TraceLevel::Verbose)},
+};
+static_assert(kTraceCategoryCount == 6, "update g_levels initializer");
+} // namespace trace_detail
+
+static const char* const kCategoryNames[kTraceCategoryCount] = {
+    "memory", "session", "names", "wins", "netplay", "poll",
+};
+
+const char* trace_category_name(TraceCategory category) {
+    const size_t i = static_cast<size_t>(category);
+    return i < kTraceCategoryCount ? kCategoryNames[i] : "?";
+}
+
+uint32_t trace_mask() { return trace_detail::g_mask.load(std::memory_order_relaxed); }
+
+void set_trace_mask(uint32_t mask) { trace_detail::g_mask.store(mask, std::memory_order_relaxed); }
+
+void set_trace_level(TraceCategory category, TraceLevel level) {
+    const size_t i = static_cast<size_t>(category);
+    if (i < kTraceCategoryCount) trace_detail::g_levels[i].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+static bool parse_level(const std::string& s, TraceLevel& out) {
+    static const char* const names[] = {"off", "error", "info", "debug", "verbose"};
+    for (int i = 0; i <= 4; ++i) {
+        if (s == names[i] || (s.size() == 1 && s[0] == char('0' + i))) {
+            out = static_cast<TraceLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void trace_init() {
+    // Category names are ASCII; lowercase and narrow in one pass.
+    std::string spec;
+#ifdef _WIN32
+    wchar_t buf[256];
+    DWORD n = GetEnvironmentVariableW(L"EFZDA_TRACE", buf, _countof(buf));
+    if (n == 0 || n >= _countof(buf)) return; // keep defaults
+    for (DWORD i = 0; i < n; ++i) spec.push_back(static_cast<char>(std::towlower(buf[i]) & 0x7F));
+#else
+    const char* env = std::getenv("EFZDA_TRACE");
+    if (!env || !*env) return; // keep defaults
+    for (const char* p = env; *p; ++p) spec.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(*p)) & 0x7F));
+#endif
+
+    uint32_t mask = 0;
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        size_t comma = spec.find(',', pos);
+        if (comma == std::string::npos) comma = spec.size();
+        std::string entry = spec.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (entry.empty()) continue;
+
+        TraceLevel level = TraceLevel::Verbose;
+        const size_t colon = entry.find(':');
+        if (colon != std::string::npos) {
+            if (!parse_level(entry.substr(colon + 1), level)) {
+                log("Trace: ignoring bad level in '%s'", entry.c_str());
+                continue;
+            }
+            entry.resize(colon);
+        }
+        bool matched = false;
+        for (size_t c = 0; c < kTraceCategoryCount; ++c) {
+            if (entry == "all" || entry == kCategoryNames[c]) {
+                set_trace_level(static_cast<TraceCategory>(c), level);
+                if (level == TraceLevel::Off) mask &= ~(1u << c);
+                else mask |= 1u << c;
+                matched = true;
+            }
+        }
+        if (!matched) log("Trace: unknown category '%s'", entry.c_str());
+    }
+    set_trace_mask(mask);
+    log("Trace: EFZDA_TRACE='%s' mask=0x%02X", spec.c_str(), (unsigned)mask);
+}
+
+} // namespace efzda
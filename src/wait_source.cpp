@@ -0,0 +1,69 @@
+#include "wait_source.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace efzda {
+
+#ifdef _WIN32
+
+Win32EventWaitSource::Win32EventWaitSource(const char* name) {
+    m_event = CreateEventA(nullptr, FALSE, FALSE, name);
+}
+
+Win32EventWaitSource::~Win32EventWaitSource() {
+    if (m_event) CloseHandle(m_event);
+}
+
+void Win32EventWaitSource::signal() {
+    if (m_event) SetEvent(m_event);
+}
+
+bool Win32EventWaitSource::wait(uint32_t timeoutMs) {
+    if (!m_event) {
+        if (timeoutMs) Sleep(timeoutMs);
+        return false;
+    }
+    return WaitForSingleObject(m_event, timeoutMs) == WAIT_OBJECT_0;
+}
+
+#else
+
+EventFdWaitSource::EventFdWaitSource() {
+    m_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+EventFdWaitSource::~EventFdWaitSource() {
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+void EventFdWaitSource::signal() {
+    if (m_fd < 0) return;
+    const uint64_t one = 1;
+    while (::write(m_fd, &one, sizeof(one)) < 0 && errno == EINTR) {}
+}
+
+bool EventFdWaitSource::wait(uint32_t timeoutMs) {
+    if (m_fd < 0) {
+        if (timeoutMs) ::usleep(static_cast<useconds_t>(timeoutMs) * 1000);
+        return false;
+    }
+    pollfd p{m_fd, POLLIN, 0};
+    int r;
+    while ((r = ::poll(&p, 1, static_cast<int>(timeoutMs))) < 0 && errno == EINTR) {}
+    if (r != 1) return false;
+    // Reading resets the counter: any number of signals is one wakeup.
+    uint64_t count = 0;
+    return ::read(m_fd, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count));
+}
+
+#endif
+
+} // namespace efzda
@@ -0,0 +1,40 @@
+// One SET_ACTIVITY frame: ActivitySerializer against the old string-built
+// frame, plus JSON escaping of a long clean string.
+#include "check.h"
+#include "legacy_activity_json.h"
+
+#include "discord/activity_serializer.h"
+
+#include <string>
+
+using namespace efzda;
+
+int main(int argc, char** argv) {
+    const bool quick = efzda_test::quick_run(argc, argv);
+    const unsigned long iters = quick ? 1000 : 1000000;
+    const DiscordActivity a{"Playing online match (SomeNickname)", "Akiko vs Mizuka 2-1", "90px-efz_akiko_icon",
+                            "Akiko Minase", "90px-efz_mizuka_icon", "Unknown"};
+    const std::string nonce = "1f2b3c4d-123";
+    ActivitySerializer ser(4242);
+    size_t total = 0;
+
+    efzda_test::bench("frame: ActivitySerializer", iters, [&] { total += ser.setActivity(&a, nonce.c_str()).size(); });
+    efzda_test::bench("frame: legacy concatenation", iters, [&] {
+        total += legacy::frame(1, legacy::set_activity_json(a, 4242, nonce)).size();
+    });
+    efzda_test::bench("activityHash", iters, [&] { total += static_cast<size_t>(ser.activityHash(&a)); });
+
+    std::string text(4000, 'x');
+    text[3000] = '"';
+    std::string out;
+    out.reserve(2 * text.size());
+    const unsigned long escIters = quick ? 100 : 50000;
+    efzda_test::bench("escape 4 KB: append_json_escaped", escIters, [&] {
+        out.clear();
+        append_json_escaped(out, text.data(), text.size());
+        total += out.size();
+    });
+    efzda_test::bench("escape 4 KB: legacy escape_json", escIters, [&] { total += legacy::escape_json(text).size(); });
+    efzda_test::keep(total);
+    return 0;
+}
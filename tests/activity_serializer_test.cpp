@@ -0,0 +1,105 @@
+// ActivitySerializer must produce the same bytes as the string-built frames
+// it replaced, for any field contents, and hash what it would send.
+#include "check.h"
+#include "legacy_activity_json.h"
+
+#include "discord/activity_serializer.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace efzda;
+
+namespace {
+
+constexpr uint32_t kPid = 4242;
+
+bool same_as_legacy(ActivitySerializer& ser, const DiscordActivity* a, const std::string& nonce) {
+    const std::string& got = ser.setActivity(a, nonce.c_str());
+    const std::string want = legacy::frame(1, a ? legacy::set_activity_json(*a, kPid, nonce) : legacy::clear_activity_json(kPid, nonce));
+    if (got == want) return true;
+    std::fprintf(stderr, "  got:  %s\n  want: %s\n", got.c_str() + 8, want.c_str() + 8);
+    return false;
+}
+
+void test_fixed_cases() {
+    ActivitySerializer ser(kPid);
+    DiscordActivity a{"Playing online match (Nick)", "Akiko vs Mizuka 2-1", "90px-efz_akiko_icon", "Akiko Minase",
+                      "90px-efz_mizuka_icon", "Unknown"};
+    CHECK(same_as_legacy(ser, &a, "0badf00d-1"));
+    CHECK(same_as_legacy(ser, nullptr, "0badf00d-2"));
+    CHECK(same_as_legacy(ser, &a, "0badf00d-3")); // buffer reuse after a clear
+    const DiscordActivity empty;
+    CHECK(same_as_legacy(ser, &empty, "n"));
+    DiscordActivity smallOnly{"", "", "icon", "text", "", "dropped without a large image"};
+    CHECK(same_as_legacy(ser, &smallOnly, "n"));
+    DiscordActivity largeTextOnly{"d", "", "", "no small key", "", "no large key"};
+    CHECK(same_as_legacy(ser, &largeTextOnly, "n"));
+    DiscordActivity escapes{"\"quoted\" \\ path", "tab\there\nnew\rline", "\x01\x1f", "\x7f", "caf\xc3\xa9", "\xe3\x81\x82"};
+    CHECK(same_as_legacy(ser, &escapes, "n"));
+    // Long enough for the 16-byte scan, with the escape in the last block.
+    DiscordActivity longRun{std::string(47, 'x') + "\"", std::string(64, 'y'), "", "", "", ""};
+    CHECK(same_as_legacy(ser, &longRun, "n"));
+}
+
+void test_random_activities() {
+    std::mt19937 rng(7);
+    ActivitySerializer ser(kPid);
+    const char alpha[] = "abc \"\\\n\t\r\x01\x1f\x7f\xc3\xa9XYZ0123456789";
+    auto random_string = [&] {
+        std::string s;
+        const int n = rng() % 3 == 0 ? 0 : static_cast<int>(rng() % 70);
+        for (int i = 0; i < n; ++i) s += rng() % 4 ? alpha[rng() % 10 + 10] : alpha[rng() % (sizeof(alpha) - 1)];
+        return s;
+    };
+    unsigned mismatches = 0;
+    for (int i = 0; i < 100000; ++i) {
+        DiscordActivity a{random_string(), random_string(), random_string(), random_string(), random_string(), random_string()};
+        if (!same_as_legacy(ser, i % 50 == 0 ? nullptr : &a, std::to_string(i)) && ++mismatches > 5) break;
+    }
+    CHECK(mismatches == 0);
+}
+
+void test_escape() {
+    std::string out = "prefix:";
+    append_json_escaped(out, "a\"b\\c\x02", 6);
+    CHECK(out == "prefix:a\\\"b\\\\c\\u0002");
+    for (size_t len = 0; len < 40; ++len) {
+        for (size_t at = 0; at < len; ++at) {
+            std::string s(len, 'q');
+            s[at] = '\n';
+            std::string got;
+            append_json_escaped(got, s.data(), s.size());
+            CHECK(got == legacy::escape_json(s));
+        }
+    }
+}
+
+void test_activity_hash() {
+    ActivitySerializer ser(kPid);
+    DiscordActivity a{"details", "state", "small", "small text", "large", "large text"};
+    const uint64_t h = ser.activityHash(&a);
+    CHECK(h == ser.activityHash(&a));
+    ser.setActivity(&a, "nonce-1");
+    CHECK(h == ser.activityHash(&a)); // the nonce is not part of it
+    DiscordActivity b = a;
+    b.state = "state2";
+    CHECK(ser.activityHash(&b) != h);
+    // Text that is not sent (large_text without a large image) does not count.
+    DiscordActivity c{"d", "", "", "", "", "x"};
+    DiscordActivity d{"d", "", "", "", "", "y"};
+    CHECK(ser.activityHash(&c) == ser.activityHash(&d));
+    CHECK(ser.activityHash(nullptr) != h);
+    CHECK(ActivitySerializer(1).activityHash(&a) == h); // pid is not part of it
+}
+
+} // namespace
+
+int main() {
+    test_fixed_cases();
+    test_random_activities();
+    test_escape();
+    test_activity_hash();
+    return efzda_test::check_result("activity_serializer_test");
+}
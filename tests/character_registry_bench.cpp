@@ -0,0 +1,43 @@
+// Raw name -> display name + icon key for both players, the way a poll
+// needs them: registry probe against the old string path.
+#include "check.h"
+#include "legacy_character_path.h"
+
+#include "state/character_registry.h"
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace efzda;
+
+int main(int argc, char** argv) {
+    const unsigned long iters = efzda_test::quick_run(argc, argv) ? 1000 : 2000000;
+    std::vector<std::array<char, 12>> names;
+    for (CharacterId id = 1; id <= character_count(); ++id) {
+        std::array<char, 12> raw{};
+        std::memcpy(raw.data(), character_info(id)->raw, std::strlen(character_info(id)->raw));
+        names.push_back(raw);
+    }
+    std::array<char, 12> garbage{};
+    std::memcpy(garbage.data(), "\x13\x88zz\x01", 5);
+    names.push_back(garbage);
+
+    size_t i = 0;
+    size_t total = 0;
+    efzda_test::bench("registry (2 players)", iters, [&] {
+        for (int p = 0; p < 2; ++p) {
+            const CharacterInfo* info = character_info(find_character(names[i++ % names.size()].data(), 12));
+            total += info ? std::strlen(info->iconKey) : 0;
+        }
+    });
+    efzda_test::bench("legacy string path (2 players)", iters, [&] {
+        for (int p = 0; p < 2; ++p) {
+            const std::string display = legacy::character_name(names[i++ % names.size()].data());
+            total += legacy::small_icon_key(display).size();
+        }
+    });
+    efzda_test::keep(total);
+    return 0;
+}
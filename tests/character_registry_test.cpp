@@ -0,0 +1,79 @@
+// Character registry: same answers as the string path it replaced, for
+// every character and for random garbage.
+#include "check.h"
+#include "legacy_character_path.h"
+
+#include "state/character_registry.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace efzda;
+
+namespace {
+
+void test_matches_legacy_path() {
+    CHECK(character_count() == 25);
+    for (CharacterId id = 1; id <= character_count(); ++id) {
+        const CharacterInfo* info = character_info(id);
+        CHECK(info != nullptr);
+        if (!info) continue;
+        char raw[12] = {};
+        std::memcpy(raw, info->raw, std::strlen(info->raw));
+        CHECK(find_character(raw, sizeof(raw)) == id);
+        const std::string display = legacy::character_name(raw);
+        if (!CHECK(display == info->displayName)) std::fprintf(stderr, "  %s: '%s' vs '%s'\n", info->raw, display.c_str(), info->displayName);
+        CHECK(legacy::small_icon_key(display) == info->iconKey);
+        CHECK(legacy::small_icon_key(display) == info->largeImageKey);
+        CHECK(std::strcmp(character_display_name(id), info->displayName) == 0);
+
+        // Upper case and embedded control characters normalise the same way.
+        char noisy[12] = {};
+        size_t n = 0;
+        for (const char* p = info->raw; *p && n < 11; ++p) {
+            noisy[n++] = static_cast<char>(*p - 'a' + 'A');
+            if (n == 1) noisy[n++] = '\x01';
+        }
+        CHECK(find_character(noisy, sizeof(noisy)) == (legacy::character_name(noisy).empty() ? kNoCharacter : id));
+    }
+    CHECK(character_info(kNoCharacter) == nullptr);
+    CHECK(character_info(static_cast<CharacterId>(character_count() + 1)) == nullptr);
+    CHECK(std::strcmp(character_display_name(kNoCharacter), "") == 0);
+}
+
+void test_rejects_like_legacy_path() {
+    const char* const near[] = {"", "ak", "akan", "akanee", "neyuki", "nayukic", "mizukabb", "unknown", "Akane\x7F"};
+    for (const char* s : near) {
+        char raw[12] = {};
+        std::memcpy(raw, s, std::strlen(s));
+        CHECK((find_character(raw, sizeof(raw)) == kNoCharacter) == legacy::character_name(raw).empty());
+    }
+    CHECK(find_character(nullptr, 12) == kNoCharacter);
+
+    // Random bytes, and names with random trailing garbage after the NUL.
+    std::mt19937 rng(42);
+    unsigned disagreements = 0;
+    for (int i = 0; i < 200000; ++i) {
+        char raw[12];
+        for (char& c : raw) c = static_cast<char>(rng() % 4 == 0 ? 'a' + rng() % 26 : rng());
+        if (i % 2) {
+            const CharacterInfo* info = character_info(static_cast<CharacterId>(1 + rng() % character_count()));
+            const size_t len = std::strlen(info->raw);
+            std::memcpy(raw, info->raw, len);
+            if (len < sizeof(raw)) raw[len] = '\0';
+        }
+        const CharacterId id = find_character(raw, sizeof(raw));
+        const std::string display = legacy::character_name(raw);
+        if ((id == kNoCharacter) != display.empty() || (id != kNoCharacter && display != character_display_name(id))) ++disagreements;
+    }
+    CHECK(disagreements == 0);
+}
+
+} // namespace
+
+int main() {
+    test_matches_legacy_path();
+    test_rejects_like_legacy_path();
+    return efzda_test::check_result("character_registry_test");
+}
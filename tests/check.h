@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Minimal test and benchmark helpers: no framework, so the tests build
+// wherever the portable sources do. A failed CHECK prints its location and
+// makes the test's main() return non-zero through check_result().
+
+namespace efzda_test {
+
+inline int& failures() {
+    static int s_failures = 0;
+    return s_failures;
+}
+
+inline bool check(bool ok, const char* expr, const char* file, int line) {
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expr);
+        ++failures();
+    }
+    return ok;
+}
+
+inline int check_result(const char* name) {
+    if (failures()) std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures());
+    else std::printf("%s: ok\n", name);
+    return failures() ? 1 : 0;
+}
+
+// Benchmarks run their full iteration count by default; ctest passes
+// --quick so they only prove they still work.
+inline bool quick_run(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--quick") == 0) return true;
+    return false;
+}
+
+// Runs fn() `iters` times and prints the mean cost per call.
+template <typename Fn>
+double bench(const char* name, unsigned long iters, Fn&& fn) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point t0 = Clock::now();
+    for (unsigned long i = 0; i < iters; ++i) fn();
+    const double ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+    const double per = iters ? ns / static_cast<double>(iters) : 0.0;
+    std::printf("%-40s %10lu iters %12.1f ns/op\n", name, iters, per);
+    return per;
+}
+
+// Keeps a computed value alive so the optimizer cannot drop the work.
+template <typename T>
+inline void keep(const T& value) {
+    static volatile unsigned char s_sink;
+    s_sink = static_cast<unsigned char>(s_sink + *reinterpret_cast<const volatile unsigned char*>(&value));
+}
+
+} // namespace efzda_test
+
+#define CHECK(expr) ::efzda_test::check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
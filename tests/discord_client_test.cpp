@@ -0,0 +1,235 @@
+// DiscordClient's writer against a mock Discord client on a Unix socket:
+// handshake and READY, nonce-matched acks, PING/PONG, suppression of
+// unchanged updates, ERROR replies and resend, CLOSE and reconnect, and the
+// final clear on shutdown.
+#include "check.h"
+
+#include "discord/discord_client.h"
+#include "discord/ipc_frame.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The client logs through efzda::log(); keep the lines for checks instead
+// of linking the Windows logger.
+namespace {
+std::mutex g_logMutex;
+std::vector<std::string> g_logLines;
+} // namespace
+
+namespace efzda {
+void log(const char* fmt, ...) {
+    char buf[1024];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    g_logLines.emplace_back(buf);
+}
+void logw(const wchar_t*, ...) {}
+} // namespace efzda
+
+using namespace efzda;
+
+namespace {
+
+bool logged(const char* text) {
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    for (const std::string& line : g_logLines)
+        if (line.find(text) != std::string::npos) return true;
+    return false;
+}
+
+// The Discord end of the socket, driven from the test thread.
+class MockDiscord {
+public:
+    explicit MockDiscord(const std::string& path) : m_path(path) {
+        m_listen = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        if (::bind(m_listen, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(m_listen, 4) != 0) {
+            ::close(m_listen);
+            m_listen = -1;
+        }
+    }
+    ~MockDiscord() {
+        drop();
+        if (m_listen >= 0) ::close(m_listen);
+        ::unlink(m_path.c_str());
+    }
+    bool ok() const { return m_listen >= 0; }
+
+    bool accept(int timeoutMs) {
+        drop();
+        pollfd p{m_listen, POLLIN, 0};
+        if (::poll(&p, 1, timeoutMs) != 1) return false;
+        m_client = ::accept(m_listen, nullptr, nullptr);
+        m_decoder.reset();
+        return m_client >= 0;
+    }
+    void drop() {
+        if (m_client >= 0) ::close(m_client);
+        m_client = -1;
+    }
+
+    bool send(uint32_t op, const std::string& json) {
+        const std::string f = encode_ipc_frame(op, json);
+        return m_client >= 0 && ::send(m_client, f.data(), f.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(f.size());
+    }
+
+    // Next frame from the client, or false after timeoutMs.
+    bool receive(IpcFrame& frame, int timeoutMs) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!m_decoder.next(frame)) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(until - std::chrono::steady_clock::now()).count();
+            if (left <= 0 || m_client < 0) return false;
+            pollfd p{m_client, POLLIN, 0};
+            if (::poll(&p, 1, static_cast<int>(left)) != 1) return false;
+            char buf[4096];
+            const ssize_t n = ::recv(m_client, buf, sizeof(buf), 0);
+            if (n <= 0) return false;
+            m_decoder.feed(buf, static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    // Receive a SET_ACTIVITY and return its nonce ("" on timeout).
+    std::string receive_set_activity(std::string& json, int timeoutMs = 2000) {
+        IpcFrame f;
+        std::string cmd, nonce;
+        if (!receive(f, timeoutMs) || f.op != kIpcFrame) return {};
+        json = f.json;
+        if (!json_top_level_string(f.json, "cmd", cmd) || cmd != "SET_ACTIVITY") return {};
+        json_top_level_string(f.json, "nonce", nonce);
+        return nonce;
+    }
+
+    bool ack(const std::string& nonce) {
+        return send(kIpcFrame, "{\"cmd\":\"SET_ACTIVITY\",\"data\":{\"details\":\"x\"},\"evt\":null,\"nonce\":\"" + nonce + "\"}");
+    }
+
+    // Accept the connection, check the handshake and answer READY.
+    bool handshake(const char* clientId) {
+        IpcFrame f;
+        std::string id;
+        if (!accept(3000) || !receive(f, 2000)) return false;
+        if (f.op != kIpcHandshake || !json_top_level_string(f.json, "client_id", id) || id != clientId) return false;
+        return send(kIpcFrame, "{\"cmd\":\"DISPATCH\",\"data\":{\"v\":1,\"config\":{}},\"evt\":\"READY\",\"nonce\":null}");
+    }
+
+private:
+    std::string m_path;
+    int m_listen = -1;
+    int m_client = -1;
+    IpcFrameDecoder m_decoder;
+};
+
+template <typename Pred>
+bool eventually(Pred pred, int timeoutMs = 2000) {
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() >= until) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+bool contains(const std::string& s, const char* part) {
+    return s.find(part) != std::string::npos;
+}
+
+void run(const std::string& dir) {
+    MockDiscord discord(dir + "/discord-ipc-0");
+    CHECK(discord.ok());
+
+    DiscordClient client;
+    CHECK(!client.init(""));
+    CHECK(client.init("1234567890"));
+    CHECK(discord.handshake("1234567890"));
+    CHECK(eventually([] { return logged("READY"); }));
+
+    // An update goes out once and is matched to its reply by nonce.
+    client.updatePresence("In a match", "Akiko vs Mizuka", "small", "", "large", "Large");
+    std::string json;
+    std::string nonce = discord.receive_set_activity(json);
+    CHECK(!nonce.empty());
+    CHECK(contains(json, "\"details\":\"In a match\"") && contains(json, "\"large_image\":\"large\""));
+    CHECK(discord.ack(nonce));
+    CHECK(eventually([&] { return client.stats().acked == 1; }));
+
+    // PING is answered with a PONG carrying the same payload.
+    CHECK(discord.send(kIpcPing, "{\"ping\":42}"));
+    IpcFrame pong;
+    CHECK(discord.receive(pong, 2000) && pong.op == kIpcPong && pong.json == "{\"ping\":42}");
+
+    // The same activity again is not sent, unless forced.
+    client.updatePresence("In a match", "Akiko vs Mizuka", "small", "", "large", "Large");
+    CHECK(eventually([&] { return client.stats().suppressed == 1; }));
+    IpcFrame none;
+    CHECK(!discord.receive(none, 200));
+    client.updatePresence("In a match", "Akiko vs Mizuka", "small", "", "large", "Large", true);
+    nonce = discord.receive_set_activity(json);
+    CHECK(!nonce.empty() && discord.ack(nonce));
+    CHECK(eventually([&] { return client.stats().acked == 2; }));
+
+    // A reply to someone else's nonce is ignored; an ERROR for ours makes
+    // the writer back off and send the update again.
+    client.updatePresence("Character select", "Choosing");
+    nonce = discord.receive_set_activity(json);
+    CHECK(!nonce.empty());
+    CHECK(discord.ack("00000000-1"));
+    CHECK(discord.send(kIpcFrame, "{\"cmd\":\"SET_ACTIVITY\",\"data\":{\"code\":4000,\"message\":\"bad\"},\"evt\":\"ERROR\",\"nonce\":\"" + nonce + "\"}"));
+    CHECK(eventually([&] { return client.stats().rejected == 1; }));
+    const std::string resent = discord.receive_set_activity(json, 3000);
+    CHECK(!resent.empty() && resent != nonce && contains(json, "\"details\":\"Character select\""));
+    CHECK(discord.ack(resent));
+    CHECK(eventually([&] { return client.stats().acked == 3; }));
+
+    // CLOSE drops the connection; the next update reconnects first.
+    CHECK(discord.send(kIpcClose, "{\"code\":1000,\"message\":\"bye\"}"));
+    CHECK(eventually([] { return logged("Closed by Discord"); }));
+    client.updatePresence("Main menu", "");
+    CHECK(discord.handshake("1234567890"));
+    nonce = discord.receive_set_activity(json);
+    CHECK(!nonce.empty() && contains(json, "\"details\":\"Main menu\""));
+    CHECK(discord.ack(nonce));
+    CHECK(eventually([&] { return client.stats().acked == 4; }));
+
+    // Shutdown flushes the pending clear over the live connection.
+    client.clearPresence();
+    client.shutdown();
+    nonce = discord.receive_set_activity(json);
+    CHECK(!nonce.empty() && contains(json, "\"activity\":null"));
+
+    const DiscordClientStats s = client.stats();
+    std::printf("discord client: sent=%u acked=%u rejected=%u lost=%u suppressed=%u failed=%u\n", s.sent, s.acked,
+                s.rejected, s.lost, s.suppressed, s.failed);
+    CHECK(s.acked == 4 && s.rejected == 1 && s.suppressed == 1 && s.lost == 0);
+}
+
+} // namespace
+
+int main() {
+    char dir[] = "/tmp/efzda-discord-XXXXXX";
+    CHECK(::mkdtemp(dir) != nullptr);
+    // The writer searches $XDG_RUNTIME_DIR first.
+    ::setenv("XDG_RUNTIME_DIR", dir, 1);
+    ::unsetenv("TMPDIR");
+    run(dir);
+    ::rmdir(dir);
+    return efzda_test::check_result("discord_client_test");
+}
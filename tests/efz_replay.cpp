@@ -0,0 +1,68 @@
+// Replays a poll recording (EFZDA_RECORD, memory/snapshot_file.h) through
+// GameStateProvider and prints the presence timeline, one line per poll
+// whose text changed:
+//
+//   efz_replay <snapshot file> [--all] [--verbose]
+//
+// Columns are tab-separated: poll, tick, details, state, large image key,
+// small image key. --all prints every poll, --verbose passes the provider's
+// log lines to stderr. The recording has to come from a build with the same
+// pointer width (efz.exe recordings need a 32-bit build).
+#include "state/game_state_provider.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+bool g_verbose = false;
+} // namespace
+
+namespace efzda {
+void log(const char* fmt, ...) {
+    if (!g_verbose) return;
+    va_list args;
+    va_start(args, fmt);
+    std::vfprintf(stderr, fmt, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+}
+void logw(const wchar_t*, ...) {}
+} // namespace efzda
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    bool all = false;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--all") == 0) all = true;
+        else if (std::strcmp(argv[i], "--verbose") == 0) g_verbose = true;
+        else if (!path && argv[i][0] != '-') path = argv[i];
+        else usage = true;
+    }
+    if (!path || usage) {
+        std::fprintf(stderr, "usage: efz_replay <snapshot file> [--all] [--verbose]\n");
+        return 2;
+    }
+
+    efzda::GameStateProvider provider;
+    std::vector<efzda::ReplayedPoll> timeline;
+    std::string error;
+    if (!provider.replay(path, timeline, &error)) {
+        std::fprintf(stderr, "efz_replay: %s: %s\n", path, error.c_str());
+        return 1;
+    }
+    size_t changes = 0;
+    std::printf("poll\ttick\tdetails\tstate\tlarge\tsmall\n");
+    for (const efzda::ReplayedPoll& p : timeline) {
+        if (p.changed) ++changes;
+        if (!p.changed && !all) continue;
+        std::printf("%u\t%llu\t%s\t%s\t%s\t%s\n", (unsigned)p.poll, (unsigned long long)p.tick,
+                    p.text.details.c_str(), p.text.state.c_str(),
+                    p.text.largeImageKey.c_str(), p.text.smallImageKey.c_str());
+    }
+    std::fprintf(stderr, "%zu polls, %zu presence changes\n", timeline.size(), changes);
+    return 0;
+}
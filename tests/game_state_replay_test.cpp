@@ -0,0 +1,125 @@
+// GameStateProvider::replay() on a recording written with SnapshotWriter
+// (replay_session.h), decoded off Windows from the recorded reads alone.
+#include "check.h"
+#include "replay_session.h"
+
+#include "efz_netplay_state.h"
+#include "state/game_state_provider.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace efzda {
+void log(const char*, ...) {}
+void logw(const wchar_t*, ...) {}
+} // namespace efzda
+
+using namespace efzda;
+
+namespace {
+
+bool contains(const std::string& s, const char* part) { return s.find(part) != std::string::npos; }
+
+void test_replay_session(const std::string& path) {
+    CHECK(efzda_test::write_replay_session(path));
+    GameStateProvider provider;
+    std::vector<ReplayedPoll> timeline;
+    std::string error;
+    CHECK(provider.replay(path, timeline, &error));
+    CHECK(error.empty());
+    CHECK(timeline.size() == efzda_test::kReplaySessionPolls);
+    if (timeline.size() != efzda_test::kReplaySessionPolls) return;
+    for (size_t i = 0; i < timeline.size(); ++i) {
+        CHECK(timeline[i].poll == i + 1);
+        CHECK(timeline[i].tick == efzda_test::kReplaySession[i].tick);
+    }
+    CHECK(timeline[0].changed);
+    CHECK(timeline[0].text.details == "Main Menu");
+    CHECK(timeline[0].text.largeImageKey == "efz_icon");
+    // Character select: the mode is known, nobody is picked yet.
+    CHECK(timeline[1].changed);
+    CHECK(timeline[1].text.details == "Playing in VS CPU");
+    CHECK(timeline[1].text.state.empty());
+    CHECK(timeline[1].text.smallImageKey.empty());
+    // In the match: P1 in the state line and large image, P2 as small image.
+    const PresenceText& match = timeline[2].text;
+    CHECK(timeline[2].changed);
+    CHECK(match.details == "Playing in VS CPU");
+    CHECK(match.state == "As Akiko Minase");
+    CHECK(match.largeImageKey == "90px-efz_akiko_icon");
+    CHECK(match.smallImageKey == "90px-efz_mayu_icon");
+    CHECK(!timeline[3].changed && timeline[3].text == match);
+    CHECK(!timeline[4].changed && timeline[4].text == match);
+    CHECK(timeline[4].state == timeline[3].state);
+    // Back on the title screen.
+    CHECK(timeline[5].changed);
+    CHECK(timeline[5].text == timeline[0].text);
+}
+
+void test_pointer_width_mismatch(const std::string& path) {
+    CHECK(efzda_test::write_replay_session(path));
+    std::FILE* f = std::fopen(path.c_str(), "r+b");
+    CHECK(f != nullptr);
+    if (!f) return;
+    const uint32_t other = sizeof(uintptr_t) == 8 ? 4 : 8;
+    std::fseek(f, offsetof(SnapshotFileHeader, pointerSize), SEEK_SET);
+    CHECK(std::fwrite(&other, sizeof(other), 1, f) == 1);
+    std::fclose(f);
+
+    GameStateProvider provider;
+    std::vector<ReplayedPoll> timeline;
+    std::string error;
+    CHECK(!provider.replay(path, timeline, &error));
+    CHECK(contains(error, "-byte pointers"));
+}
+
+// A poll whose export block is shorter than the structSize its header
+// declares (or than the header itself) ends the replay like a torn record.
+void test_truncated_export(const std::string& path, uint32_t exportSize) {
+    CHECK(efzda_test::write_replay_session(path));
+    {
+        SnapshotWriter w;
+        CHECK(w.open(path));
+        SnapshotPollHeader h{};
+        h.poll = efzda_test::kReplaySessionPolls + 1;
+        h.tick = 4000;
+        h.efzBase = efzda_test::kReplayEfzBase;
+        w.beginPoll(h);
+        const uint32_t block[4] = {EFZ_NETPLAY_STATE_MAGIC, 1, 512, 0}; // claims 512 bytes
+        w.setExport(kSnapshotExportSharedMemory, block, exportSize);
+        CHECK(w.endPoll());
+    }
+
+    SnapshotReader reader;
+    CHECK(reader.load(path));
+    CHECK(reader.truncated());
+    CHECK(reader.pollCount() == efzda_test::kReplaySessionPolls);
+
+    GameStateProvider provider;
+    std::vector<ReplayedPoll> timeline;
+    std::string error;
+    CHECK(provider.replay(path, timeline, &error));
+    CHECK(timeline.size() == efzda_test::kReplaySessionPolls);
+}
+
+} // namespace
+
+// An optional argument names where to leave the session recording, for
+// efz_replay to be run on.
+int main(int argc, char** argv) {
+    char dir[] = "/tmp/efzda-replay-XXXXXX";
+    CHECK(::mkdtemp(dir) != nullptr);
+    const std::string path = std::string(dir) + "/session.efzsnap";
+    test_replay_session(argc > 1 ? argv[1] : path);
+    test_pointer_width_mismatch(path);
+    test_truncated_export(path, 16);
+    test_truncated_export(path, 8);
+    ::unlink(path.c_str());
+    ::rmdir(dir);
+    return efzda_test::check_result("game_state_replay_test");
+}
@@ -0,0 +1,111 @@
+// IPC frame encoding, the streaming decoder fed in arbitrary chunks, and
+// the top-level JSON string lookup used to read Discord's replies.
+#include "check.h"
+
+#include "discord/ipc_frame.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace efzda;
+
+namespace {
+
+void test_encode() {
+    const std::string f = encode_ipc_frame(kIpcFrame, "{}");
+    CHECK(f.size() == 10);
+    CHECK(f.compare(0, 8, std::string("\x01\0\0\0\x02\0\0\0", 8)) == 0);
+    CHECK(f.compare(8, 2, "{}") == 0);
+    CHECK(encode_ipc_frame(kIpcPong, "").size() == 8);
+}
+
+void test_decode_chunked() {
+    std::vector<IpcFrame> sent;
+    std::string stream;
+    std::mt19937 rng(3);
+    for (int i = 0; i < 200; ++i) {
+        IpcFrame f;
+        f.op = static_cast<uint32_t>(rng() % (kIpcPong + 1));
+        f.json = "{\"n\":" + std::to_string(i) + ",\"pad\":\"" + std::string(rng() % 9000, 'p') + "\"}";
+        stream += encode_ipc_frame(f.op, f.json);
+        sent.push_back(f);
+    }
+    // Whole stream, 1-byte pieces and random pieces all decode the same.
+    for (int mode = 0; mode < 3; ++mode) {
+        IpcFrameDecoder dec;
+        std::vector<IpcFrame> got;
+        IpcFrame f;
+        size_t at = 0;
+        while (at < stream.size()) {
+            const size_t n = mode == 0 ? stream.size() : mode == 1 ? 1 : 1 + rng() % 5000;
+            const size_t take = (std::min)(n, stream.size() - at);
+            dec.feed(stream.data() + at, take);
+            at += take;
+            while (dec.next(f)) got.push_back(f);
+        }
+        CHECK(!dec.failed());
+        bool same = got.size() == sent.size();
+        for (size_t i = 0; same && i < got.size(); ++i) same = got[i].op == sent[i].op && got[i].json == sent[i].json;
+        CHECK(same);
+    }
+}
+
+void test_decode_failures() {
+    IpcFrameDecoder dec;
+    IpcFrame f;
+    const std::string header = encode_ipc_frame(kIpcFrame, "{}");
+    dec.feed(header.data(), 5);
+    CHECK(!dec.next(f) && !dec.failed()); // partial header: wait for more
+
+    // Unknown opcode: the stream is out of sync.
+    dec.reset();
+    const std::string badOp = encode_ipc_frame(7, "{}");
+    dec.feed(badOp.data(), badOp.size());
+    CHECK(!dec.next(f) && dec.failed());
+    dec.feed(header.data(), header.size()); // ignored once failed
+    CHECK(!dec.next(f));
+
+    // Oversized length.
+    dec.reset();
+    const uint32_t hdr[2] = {kIpcFrame, IpcFrameDecoder::kMaxPayload + 1};
+    dec.feed(hdr, sizeof(hdr));
+    CHECK(!dec.next(f) && dec.failed());
+
+    // reset() recovers.
+    dec.reset();
+    dec.feed(header.data(), header.size());
+    CHECK(dec.next(f) && f.op == kIpcFrame && f.json == "{}");
+    CHECK(!dec.next(f));
+}
+
+void test_json_top_level_string() {
+    std::string v;
+    const std::string ready =
+        "{\"cmd\":\"DISPATCH\",\"data\":{\"v\":1,\"evt\":\"nested\",\"user\":{\"id\":\"1\"}},\"evt\":\"READY\",\"nonce\":null}";
+    CHECK(json_top_level_string(ready, "cmd", v) && v == "DISPATCH");
+    CHECK(json_top_level_string(ready, "evt", v) && v == "READY"); // not the nested one
+    CHECK(!json_top_level_string(ready, "nonce", v));               // null
+    CHECK(!json_top_level_string(ready, "missing", v));
+    CHECK(!json_top_level_string(ready, "v", v));                   // only inside data
+
+    CHECK(json_top_level_string(" { \"a\" : [1, {\"b\":\"]}\"}], \"k\" : \"x\\\"y\\\\z\\n\\u0041\\u00e9\" } ", "k", v));
+    CHECK(v == "x\"y\\z\nA?");
+    CHECK(json_top_level_string("{\"n\":12,\"t\":true,\"k\":\"ok\"}", "k", v) && v == "ok");
+    CHECK(json_top_level_string("{\"k\":\"\"}", "k", v) && v.empty());
+
+    for (const char* bad : {"", "[]", "\"k\"", "{", "{\"k\"", "{\"k\":", "{\"k\":\"open", "{\"a\":1 \"k\":\"x\"}",
+                            "{\"a\":{\"k\":\"x\"}", "{\"k\":\"\\u12\"}"}) {
+        CHECK(!json_top_level_string(bad, "k", v));
+    }
+}
+
+} // namespace
+
+int main() {
+    test_encode();
+    test_decode_chunked();
+    test_decode_failures();
+    test_json_top_level_string();
+    return efzda_test::check_result("ipc_frame_test");
+}
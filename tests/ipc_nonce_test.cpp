@@ -0,0 +1,74 @@
+// NonceGenerator: format, round trip through sequenceOf(), rejection of
+// foreign or malformed nonces.
+#include "check.h"
+
+#include "discord/ipc_nonce.h"
+
+#include <cstring>
+#include <set>
+#include <string>
+
+using namespace efzda;
+
+namespace {
+
+void test_format_and_round_trip() {
+    NonceGenerator gen(0x0badf00du);
+    char nonce[NonceGenerator::kMaxLen];
+    CHECK(gen.next(nonce) == 1);
+    CHECK(std::strcmp(nonce, "0badf00d-1") == 0);
+    CHECK(gen.next(nonce) == 2);
+    CHECK(std::strcmp(nonce, "0badf00d-2") == 0);
+    for (uint32_t want = 3; want < 100000; ++want) {
+        const uint32_t seq = gen.next(nonce);
+        uint32_t back = 0;
+        if (!CHECK(seq == want && gen.sequenceOf(nonce, back) && back == seq)) break;
+    }
+}
+
+void test_rejects() {
+    NonceGenerator gen(0x12345678u);
+    NonceGenerator other(0x12345679u);
+    char nonce[NonceGenerator::kMaxLen];
+    other.next(nonce);
+    uint32_t seq = 0;
+    CHECK(!gen.sequenceOf(nonce, seq)); // another generator's prefix
+    for (const char* bad : {"", "12345678-", "12345678-0", "12345678-x1", "12345678-1 ", "12345678_1",
+                            "12345678-4294967296", "12345678-00000000001", "8f14e45f-ceea-467f-a0e6-1f2b3c4d5e6f"}) {
+        CHECK(!gen.sequenceOf(bad, seq));
+    }
+    CHECK(gen.sequenceOf("12345678-4294967295", seq) && seq == 4294967295u);
+    CHECK(gen.sequenceOf("12345678-007", seq) && seq == 7);
+}
+
+void test_longest_fits() {
+    // The longest nonce (counter at UINT32_MAX) fits kMaxLen.
+    NonceGenerator gen(0xffffffffu);
+    char nonce[NonceGenerator::kMaxLen];
+    std::memset(nonce, 'z', sizeof(nonce));
+    for (int i = 0; i < 3; ++i) gen.next(nonce);
+    CHECK(std::strlen(nonce) == 10);
+    const std::string longest = "ffffffff-4294967295";
+    CHECK(longest.size() == NonceGenerator::kMaxLen - 1);
+}
+
+void test_random_prefixes() {
+    std::set<std::string> prefixes;
+    for (int i = 0; i < 64; ++i) {
+        NonceGenerator gen;
+        char nonce[NonceGenerator::kMaxLen];
+        gen.next(nonce);
+        prefixes.insert(std::string(nonce, 9));
+    }
+    CHECK(prefixes.size() >= 60); // 32 random bits each
+}
+
+} // namespace
+
+int main() {
+    test_format_and_round_trip();
+    test_rejects();
+    test_longest_fits();
+    test_random_prefixes();
+    return efzda_test::check_result("ipc_nonce_test");
+}
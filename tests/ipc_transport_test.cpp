@@ -0,0 +1,169 @@
+// UnixSocketTransport (POSIX backend) against a mock Discord socket in a
+// temporary directory, and the socket path search order.
+#include "check.h"
+
+#include "discord/ipc_transport.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace efzda;
+
+namespace {
+
+// Listening AF_UNIX socket standing in for the Discord client.
+class MockSocket {
+public:
+    explicit MockSocket(const std::string& path) : m_path(path) {
+        m_listen = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        if (::bind(m_listen, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(m_listen, 4) != 0) {
+            ::close(m_listen);
+            m_listen = -1;
+        }
+    }
+    ~MockSocket() {
+        closeClient();
+        if (m_listen >= 0) ::close(m_listen);
+        ::unlink(m_path.c_str());
+    }
+    bool ok() const { return m_listen >= 0; }
+    bool accept() {
+        m_client = ::accept(m_listen, nullptr, nullptr);
+        return m_client >= 0;
+    }
+    void closeClient() {
+        if (m_client >= 0) ::close(m_client);
+        m_client = -1;
+    }
+    int client() const { return m_client; }
+
+private:
+    std::string m_path;
+    int m_listen = -1;
+    int m_client = -1;
+};
+
+// Read until `want` bytes or EOF.
+std::string read_all(int fd, size_t want) {
+    std::string got;
+    char buf[65536];
+    while (got.size() < want) {
+        const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        got.append(buf, static_cast<size_t>(n));
+    }
+    return got;
+}
+
+// Non-blocking read() until `want` bytes, giving the peer up to a second.
+std::string transport_read(IpcTransport& t, size_t want) {
+    std::string got;
+    char buf[256];
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (got.size() < want && std::chrono::steady_clock::now() < until) {
+        const long n = t.read(buf, sizeof(buf));
+        if (n < 0) break;
+        if (n == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        got.append(buf, static_cast<size_t>(n));
+    }
+    return got;
+}
+
+void test_socket_paths() {
+    const std::vector<std::string> paths = discord_ipc_socket_paths({"/run/user/1000", "C:\\users\\x\\Temp", "", "/run/user/1000/", "/tmp"});
+    CHECK(paths.size() == 2 * 5 * 10); // Windows path and empty skipped, duplicate base merged
+    CHECK(paths.front() == "/run/user/1000/discord-ipc-0");
+    CHECK(paths[9] == "/run/user/1000/discord-ipc-9");
+    CHECK(paths[10] == "/run/user/1000/app/com.discordapp.Discord/discord-ipc-0");
+    CHECK(paths[40] == "/run/user/1000/snap.discord-canary/discord-ipc-0");
+    CHECK(paths[50] == "/tmp/discord-ipc-0");
+
+    // Without explicit bases the environment decides, with /tmp last.
+    const std::vector<std::string> env = discord_ipc_socket_paths();
+    CHECK(!env.empty() && env[env.size() - 50] == "/tmp/discord-ipc-0");
+}
+
+void test_connect_and_exchange(const std::string& dir) {
+    UnixSocketTransport transport({dir});
+    CHECK(std::string(transport.name()) == "unix-socket");
+    CHECK(!transport.connect()); // nobody listening
+    CHECK(!transport.isOpen() && transport.path().empty());
+    char byte;
+    CHECK(transport.read(&byte, 1) == -1);
+    CHECK(!transport.write("x", 1));
+
+    // discord-ipc-0 is left over from a client that crashed: skipped.
+    const std::string stale = dir + "/discord-ipc-0";
+    {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, stale.c_str(), stale.size() + 1);
+        CHECK(::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+        ::close(fd); // no unlink, like a crash
+    }
+
+    MockSocket server(dir + "/discord-ipc-2");
+    CHECK(server.ok());
+    CHECK(transport.connect());
+    CHECK(transport.isOpen());
+    CHECK(transport.path() == dir + "/discord-ipc-2");
+    CHECK(server.accept());
+
+    // Nothing waiting: read() does not block.
+    CHECK(transport.read(&byte, 1) == 0);
+
+    // A write larger than the socket buffer goes out whole, in order.
+    std::string big(1 << 20, '\0');
+    for (size_t i = 0; i < big.size(); ++i) big[i] = static_cast<char>(i * 7);
+    std::string received;
+    std::thread reader([&] { received = read_all(server.client(), big.size()); });
+    CHECK(transport.write(big.data(), big.size()));
+    reader.join();
+    CHECK(received == big);
+
+    // Replies arrive in whatever chunks the peer sent.
+    const std::string reply = "{\"evt\":\"READY\"}";
+    CHECK(::send(server.client(), reply.data(), 5, 0) == 5);
+    CHECK(::send(server.client(), reply.data() + 5, reply.size() - 5, 0) == static_cast<ssize_t>(reply.size() - 5));
+    CHECK(transport_read(transport, reply.size()) == reply);
+
+    // Peer gone: read reports it, write fails instead of raising SIGPIPE.
+    server.closeClient();
+    CHECK(transport.read(&byte, 1) == -1);
+    bool failed = false;
+    for (int i = 0; i < 8 && !failed; ++i) failed = !transport.write(big.data(), 4096);
+    CHECK(failed);
+    CHECK(transport.isOpen()); // the caller decides when to reconnect
+
+    // Reconnect reaches the same listener again.
+    CHECK(transport.connect());
+    CHECK(server.accept());
+    CHECK(transport.write("ping", 4));
+    CHECK(read_all(server.client(), 4) == "ping");
+    transport.close();
+    CHECK(!transport.isOpen() && transport.path().empty());
+    ::unlink(stale.c_str());
+}
+
+} // namespace
+
+int main() {
+    test_socket_paths();
+    char dir[] = "/tmp/efzda-ipc-XXXXXX";
+    CHECK(::mkdtemp(dir) != nullptr);
+    test_connect_and_exchange(dir);
+    ::rmdir(dir);
+    return efzda_test::check_result("ipc_transport_test");
+}
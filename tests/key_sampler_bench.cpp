@@ -0,0 +1,79 @@
+// Per-sample cost of KeySampler: the three region-map reads of one sample
+// timed in a loop, then the sampler thread itself at a 1 ms interval
+// against key fields in this process, with its own per-sample accounting.
+// A second run with a 1 ns budget shows the interval backing off.
+#include "check.h"
+
+#include "state/key_sampler.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+using namespace efzda;
+
+namespace {
+
+// Stand-ins for the character slots and the screen index.
+struct KeyFields {
+    uintptr_t p1 = 0x1000;
+    uintptr_t p2 = 0x2000;
+    uint8_t screen = 3;
+};
+
+KeySamplerConfig config_for(const KeyFields& k, uint32_t budgetNs) {
+    KeySamplerConfig cfg;
+    cfg.p1Slot = reinterpret_cast<uintptr_t>(&k.p1);
+    cfg.p2Slot = reinterpret_cast<uintptr_t>(&k.p2);
+    cfg.screenAddr = reinterpret_cast<uintptr_t>(&k.screen);
+    cfg.intervalMs = 1;
+    cfg.budgetNs = budgetNs;
+    return cfg;
+}
+
+void run_sampler(const char* name, const KeyFields& k, uint32_t budgetNs, std::chrono::milliseconds runFor) {
+    KeySampler sampler;
+    if (!sampler.start(config_for(k, budgetNs))) {
+        std::printf("%-40s failed to start\n", name);
+        return;
+    }
+    const auto until = std::chrono::steady_clock::now() + runFor;
+    uint64_t popped = 0;
+    KeySample s;
+    while (std::chrono::steady_clock::now() < until) {
+        while (sampler.samples().tryPop(s)) ++popped;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    sampler.stop();
+    while (sampler.samples().tryPop(s)) ++popped;
+    const KeySamplerStats st = sampler.stats();
+    std::printf("%-40s %10llu samples %10.1f ns/sample (max %llu ns)\n", name, (unsigned long long)st.samples,
+                st.samples ? static_cast<double>(st.totalNs) / static_cast<double>(st.samples) : 0.0,
+                (unsigned long long)st.maxNs);
+    std::printf("%-40s %10llu popped %10llu dropped, interval %u ms after %u backoffs\n", "",
+                (unsigned long long)popped, (unsigned long long)st.dropped, (unsigned)st.intervalMs, (unsigned)st.backoffs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = efzda_test::quick_run(argc, argv);
+    const unsigned long iters = quick ? 10000 : 10000000;
+    KeyFields k;
+
+    // What one sample does, without the thread and the sleep.
+    RegionMapMemorySource memory;
+    efzda_test::bench("sample body (3 region-map reads)", iters, [&] {
+        KeySample s;
+        s.havePtrs = memory.read(reinterpret_cast<uintptr_t>(&k.p1), &s.p1Ptr, sizeof(s.p1Ptr)) &&
+                     memory.read(reinterpret_cast<uintptr_t>(&k.p2), &s.p2Ptr, sizeof(s.p2Ptr));
+        s.haveScreen = memory.read(reinterpret_cast<uintptr_t>(&k.screen), &s.screen, sizeof(s.screen));
+        efzda_test::keep(s);
+    });
+
+    const std::chrono::milliseconds runFor(quick ? 100 : 2000);
+    run_sampler("sampler thread, 1 ms, 50 us budget", k, 50000, runFor);
+    run_sampler("sampler thread, 1 ms, 1 ns budget", k, 1, runFor);
+    return 0;
+}
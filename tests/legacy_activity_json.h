@@ -0,0 +1,92 @@
+#pragma once
+// SET_ACTIVITY frames as the client built them before ActivitySerializer:
+// string concatenation and escape_json(), header written separately. Kept
+// verbatim as the byte-for-byte reference for activity_serializer_test and
+// the baseline for activity_serializer_bench.
+#include "discord/activity_serializer.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace legacy {
+
+inline std::string escape_json(const std::string& in) {
+    std::string out; out.reserve(in.size() + 8);
+    for (char c : in) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[7];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+inline std::string set_activity_json(const efzda::DiscordActivity& a, uint32_t pid, const std::string& nonce) {
+    const std::string& details = a.details;
+    const std::string& state = a.state;
+    const std::string& smallImageKey = a.smallImageKey;
+    const std::string& smallImageText = a.smallImageText;
+    const std::string& largeImageKey = a.largeImageKey;
+    const std::string& largeImageText = a.largeImageText;
+    std::string activity = "{";
+    bool needComma = false;
+    if (!details.empty()) {
+        activity += "\"details\":\"" + escape_json(details) + "\"";
+        needComma = true;
+    }
+    if (!state.empty()) {
+        if (needComma) activity += ",";
+        activity += "\"state\":\"" + escape_json(state) + "\"";
+        needComma = true;
+    }
+    if (!smallImageKey.empty() || !largeImageKey.empty()) {
+        if (needComma) activity += ",";
+        activity += "\"assets\":{";
+        bool first = true;
+        if (!largeImageKey.empty()) {
+            activity += "\"large_image\":\"" + escape_json(largeImageKey) + "\"";
+            if (!largeImageText.empty()) activity += ",\"large_text\":\"" + escape_json(largeImageText) + "\"";
+            first = false;
+        }
+        if (!smallImageKey.empty()) {
+            if (!first) activity += ",";
+            activity += "\"small_image\":\"" + escape_json(smallImageKey) + "\"";
+            if (!smallImageText.empty()) activity += ",\"small_text\":\"" + escape_json(smallImageText) + "\"";
+        }
+        activity += "}";
+        needComma = true;
+    }
+    if (needComma) activity += ",";
+    activity += "\"instance\":true";
+    activity += "}"; // close activity
+    return std::string("{\"cmd\":\"SET_ACTIVITY\",\"args\":{\"pid\":")
+        + std::to_string(pid) + ",\"activity\":" + activity +
+        "} ,\"nonce\":\"" + nonce + "\"}";
+}
+
+inline std::string clear_activity_json(uint32_t pid, const std::string& nonce) {
+    return std::string("{\"cmd\":\"SET_ACTIVITY\",\"args\":{\"pid\":")
+        + std::to_string(pid) + ",\"activity\":null},\"nonce\":\"" + nonce + "\"}";
+}
+
+// Header then payload, as write_frame() sent them.
+inline std::string frame(uint32_t op, const std::string& json) {
+    struct Header { uint32_t op; uint32_t len; } hdr{ op, static_cast<uint32_t>(json.size()) };
+    std::string out(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    return out + json;
+}
+
+} // namespace legacy
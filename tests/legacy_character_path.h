@@ -0,0 +1,108 @@
+#pragma once
+// The string-based character path the registry replaced (sanitize, lower,
+// kAllowedRaw, normalize_display_name, map_char_to_small_icon_key), kept
+// verbatim as the reference for character_registry_test and the baseline
+// for character_registry_bench.
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace legacy {
+
+inline std::string sanitize_ascii(const char* buf, size_t maxLen) {
+    size_t n = 0;
+    for (; n < maxLen && buf[n]; ++n) {}
+    std::string s(buf, buf + n);
+    s.erase(std::remove_if(s.begin(), s.end(), [](unsigned char c) {
+        return c < 0x20 || c == 0x7F;
+    }), s.end());
+    return s;
+}
+
+inline std::string title_case(const std::string& s) {
+    if (s.empty()) return s;
+    std::string out = s;
+    out[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(out[0])));
+    for (size_t i = 1; i < out.size(); ++i) {
+        out[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(out[i])));
+    }
+    return out;
+}
+
+inline std::string make_key(const std::string& s) {
+    std::string k;
+    k.reserve(s.size());
+    for (unsigned char c : s) {
+        if (std::isalnum(c)) k.push_back(static_cast<char>(std::tolower(c)));
+    }
+    return k;
+}
+
+inline std::string normalize_display_name(const std::string& rawLower) {
+    static const std::unordered_map<std::string, std::string> overrides = {
+        {"nagamori", "Mizuka Nagamori"}, {"mizuka", "Unknown"},        {"mizukab", "Unknown"},
+        {"nanase", "Rumi Nanase"},       {"exnanase", "Doppel Nanase"}, {"akane", "Akane Satomura"},
+        {"misaki", "Misaki Kawana"},     {"mayu", "Mayu Shiina"},       {"mio", "Mio Kouzuki"},
+        {"ayu", "Ayu Tsukimiya"},        {"nayuki", "Nayuki(Sleepy)"},  {"nayukib", "Nayuki(Awake)"},
+        {"neyuki", "Nayuki(Sleepy)"},    {"akiko", "Akiko Minase"},     {"makoto", "Makoto Sawatari"},
+        {"shiori", "Shiori Misaka"},     {"kaori", "Kaori Misaka"},     {"mai", "Mai Kawasumi"},
+        {"sayuri", "Sayuri Kurata"},     {"minagi", "Minagi Tohno"},    {"kano", "Kano Kirishima"},
+        {"misuzu", "Misuzu Kamio"},      {"kanna", "Kanna"},            {"ikumi", "Ikumi Amasawa"},
+        {"mishio", "Mishio Amano"},
+    };
+    auto it = overrides.find(make_key(rawLower));
+    if (it != overrides.end()) return it->second;
+    return title_case(rawLower);
+}
+
+// Display name for the 12 raw bytes, or "" when they are not a character.
+inline std::string character_name(const char* raw) {
+    std::string lower = sanitize_ascii(raw, 12);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    static const std::unordered_set<std::string> kAllowedRaw = {
+        "akane", "akiko", "ayu", "doppel", "exnanase", "nanase", "ikumi", "kanna", "kano", "kaori", "mai", "makoto", "mayu",
+        "minagi", "mio", "misaki", "mishio", "misuzu", "nagamori", "nayuki", "nayukib", "mizuka", "mizukab", "sayuri", "shiori",
+    };
+    if (lower.empty() || lower.size() < 3 || lower.size() > 12 || kAllowedRaw.find(lower) == kAllowedRaw.end()) return {};
+    return normalize_display_name(lower);
+}
+
+inline std::string small_icon_key(const std::string& displayName) {
+    std::string s = displayName;
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    std::string first;
+    for (char c : s) {
+        if (c == ' ' || c == '(') break;
+        if ((c >= 'a' && c <= 'z')) first.push_back(c);
+    }
+    bool isSleepy = s.find("(sleepy)") != std::string::npos;
+    if (first == "nayuki") return isSleepy ? "90px-efz_neyuki_icon" : "90px-efz_nayuki_icon";
+    if (first == "doppel") return "90px-efz_doppel_icon";
+    if (first == "rumi" || first == "nanase") return "90px-efz_rumi_icon";
+    if (first == "akane") return "90px-efz_akane_icon";
+    if (first == "akiko") return "90px-efz_akiko_icon";
+    if (first == "ayu") return "90px-efz_ayu_icon";
+    if (first == "ikumi") return "90px-efz_ikumi_icon";
+    if (first == "kanna") return "90px-efz_kanna_icon_-_copy";
+    if (first == "kano") return "90px-efz_kano_icon";
+    if (first == "kaori") return "90px-efz_kaori_icon";
+    if (first == "mai") return "90px-efz_mai_icon";
+    if (first == "makoto") return "90px-efz_makoto_icon";
+    if (first == "mayu") return "90px-efz_mayu_icon";
+    if (first == "minagi") return "90px-efz_minagi_icon";
+    if (first == "mio") return "90px-efz_mio_icon";
+    if (first == "misaki") return "90px-efz_misaki_icon";
+    if (first == "mishio") return "90px-efz_mishio_icon";
+    if (first == "misuzu") return "90px-efz_misuzu_icon";
+    if (first == "mizuka") return "90px-efz_mizuka_icon";
+    if (first == "sayuri") return "90px-efz_sayuri_icon";
+    if (first == "shiori") return "90px-efz_shiori_icon";
+    if (first == "unknown") return "90px-efz_unknown_icon";
+    if (s == "unknown") return "90px-efz_unknown_icon";
+    if (s.find("mizukab") != std::string::npos || s == "mizuka") return "90px-efz_unknown_icon";
+    return {};
+}
+
+} // namespace legacy
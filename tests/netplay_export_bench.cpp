@@ -0,0 +1,26 @@
+// Decoder throughput per export layout: one parse_netplay_export_state()
+// per changed export read on the poll thread.
+#include "check.h"
+#include "netplay_export_seeds.h"
+
+#include "state/netplay_export.h"
+
+#include <string>
+
+using namespace efzda;
+using namespace efzda_test;
+
+int main(int argc, char** argv) {
+    const unsigned long iters = efzda_test::quick_run(argc, argv) ? 1000 : 1000000;
+    size_t total = 0;
+    for (const ExportSeed& seed : export_seeds()) {
+        NetplayExportState out;
+        const std::string name = "parse " + seed.name + " (" + std::to_string(seed.bytes.size()) + " B)";
+        efzda_test::bench(name.c_str(), iters, [&] {
+            parse_netplay_export_state(seed.bytes.data(), out);
+            total += out.p2Name.size();
+        });
+    }
+    efzda_test::keep(total);
+    return 0;
+}
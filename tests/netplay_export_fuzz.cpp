@@ -0,0 +1,205 @@
+// Mutation fuzzer for parse_netplay_export_state(). Each input is placed so
+// that its last declared byte ends a page followed by an inaccessible one,
+// so any read past structSize faults; decoded results are checked against
+// invariants the provider relies on.
+//
+//   netplay_export_fuzz <corpus dir> [iterations]
+//   netplay_export_fuzz --write-corpus <dir>   (regenerate the seed files)
+//
+// Corpus files (*.hex) hold the block as whitespace-separated hex bytes;
+// lines starting with '#' are comments. A crash input can be dropped into
+// the corpus directory as is.
+#include "check.h"
+#include "netplay_export_seeds.h"
+
+#include "state/netplay_export.h"
+
+#include <dirent.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace efzda;
+using namespace efzda_test;
+
+namespace {
+
+// Two pages; the second is PROT_NONE.
+class GuardedBuffer {
+public:
+    GuardedBuffer() {
+        m_page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        void* p = mmap(nullptr, 2 * m_page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        m_base = p == MAP_FAILED ? nullptr : static_cast<uint8_t*>(p);
+        if (m_base) mprotect(m_base + m_page, m_page, PROT_NONE);
+    }
+    ~GuardedBuffer() {
+        if (m_base) munmap(m_base, 2 * m_page);
+    }
+    // Copy of `bytes` ending at the guard page.
+    const uint8_t* place(const std::vector<uint8_t>& bytes) {
+        uint8_t* at = m_base + m_page - bytes.size();
+        std::memcpy(at, bytes.data(), bytes.size());
+        return at;
+    }
+    bool ok() const { return m_base != nullptr; }
+    size_t page() const { return m_page; }
+
+private:
+    uint8_t* m_base = nullptr;
+    size_t m_page = 0;
+};
+
+// The decoder may read the 12-byte header and then structSize bytes, so an
+// input is cut or zero-padded to what its header declares.
+std::vector<uint8_t> as_declared(std::vector<uint8_t> bytes, size_t limit) {
+    if (bytes.size() < 12) bytes.resize(12, 0);
+    uint32_t structSize = 0;
+    std::memcpy(&structSize, bytes.data() + 8, sizeof(structSize));
+    if (structSize >= 12 && structSize <= limit) bytes.resize(structSize, 0);
+    else bytes.resize(12);
+    return bytes;
+}
+
+bool clean(const std::string& s, size_t maxLen) {
+    if (s.size() > maxLen) return false;
+    for (unsigned char c : s)
+        if (c < 0x20) return false;
+    return true;
+}
+
+unsigned long g_accepted = 0;
+
+void run_one(GuardedBuffer& buf, const std::vector<uint8_t>& input) {
+    const std::vector<uint8_t> bytes = as_declared(input, buf.page());
+    NetplayExportState out;
+    const bool ok = parse_netplay_export_state(buf.place(bytes), out);
+    CHECK(ok == out.valid);
+    if (!ok) return;
+    ++g_accepted;
+    uint32_t version = 0;
+    std::memcpy(&version, bytes.data() + 4, sizeof(version));
+    CHECK(out.version == version && out.structSize == bytes.size());
+    CHECK(clean(out.localNickname, 64) && clean(out.p1Name, 64) && clean(out.p2Name, 64));
+    CHECK(clean(out.revivalVersion, 16) && clean(out.connectionAddress, 64));
+    CHECK(!out.hasAsyncHost || (out.capabilityFlags & EFZ_CAP_ASYNC_HOST));
+    CHECK(!out.hasNetDetail || (out.capabilityFlags & EFZ_CAP_NET_DETAIL));
+    CHECK(!out.hasConnection || ((out.capabilityFlags & EFZ_CAP_CONNECTION) && !out.connectionAddress.empty()));
+    size_t seq = 0;
+    if (netplay_export_seq_offset(out.version, out.structSize, seq)) CHECK(seq + 4 <= out.structSize);
+}
+
+void mutate(std::vector<uint8_t>& b, std::mt19937& rng) {
+    switch (rng() % 6) {
+        case 0: // flip a few bits
+            for (int i = 0, n = 1 + static_cast<int>(rng() % 8); i < n; ++i)
+                b[rng() % b.size()] ^= static_cast<uint8_t>(1u << (rng() % 8));
+            break;
+        case 1: { // random bytes in a run
+            const size_t at = rng() % b.size();
+            for (size_t i = at; i < b.size() && i < at + 1 + rng() % 32; ++i) b[i] = static_cast<uint8_t>(rng());
+            break;
+        }
+        case 2: // structSize: anywhere near the known layouts
+            put_u32(b, 8, static_cast<uint32_t>(180 + rng() % 300));
+            break;
+        case 3: // version
+            put_u32(b, 4, rng() % 3 ? static_cast<uint32_t>(rng() % 12) : static_cast<uint32_t>(rng()));
+            break;
+        case 4: // capability bits
+            put_u32(b, offsetof(EFZNetplayState, capabilityFlags), static_cast<uint32_t>(rng()));
+            break;
+        default: // strings without terminators
+            for (size_t i = 16; i < b.size() && i < 300; ++i)
+                if (b[i] == 0 && rng() % 2) b[i] = static_cast<uint8_t>('!' + rng() % 90);
+            break;
+    }
+}
+
+std::string to_hex(const std::vector<uint8_t>& bytes) {
+    std::string s;
+    char hex[4];
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        std::snprintf(hex, sizeof(hex), "%02x", bytes[i]);
+        s += hex;
+        s += (i % 16 == 15) ? '\n' : ' ';
+    }
+    if (!s.empty() && s.back() == ' ') s.back() = '\n';
+    return s;
+}
+
+bool read_hex(const std::string& path, std::vector<uint8_t>& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    out.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] == '#') continue;
+        std::istringstream words(line);
+        std::string w;
+        while (words >> w) out.push_back(static_cast<uint8_t>(std::strtoul(w.c_str(), nullptr, 16)));
+    }
+    return !out.empty();
+}
+
+std::vector<std::string> hex_files(const std::string& dir) {
+    std::vector<std::string> files;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* e = readdir(d)) {
+            const std::string name = e->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".hex") == 0) files.push_back(dir + "/" + name);
+        }
+        closedir(d);
+    }
+    return files;
+}
+
+int write_corpus(const std::string& dir) {
+    for (const ExportSeed& seed : export_seeds()) {
+        std::ofstream out(dir + "/" + seed.name + ".hex");
+        out << "# " << seed.name << ", " << seed.bytes.size() << " bytes (netplay_export_seeds.h)\n" << to_hex(seed.bytes);
+        if (!out) return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string(argv[1]) == "--write-corpus") return write_corpus(argv[2]);
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <corpus dir> [iterations] | --write-corpus <dir>\n", argv[0]);
+        return 2;
+    }
+    const unsigned long iters = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+
+    GuardedBuffer buf;
+    CHECK(buf.ok());
+    if (!buf.ok()) return efzda_test::check_result("netplay_export_fuzz");
+
+    std::vector<std::vector<uint8_t>> corpus;
+    for (const std::string& path : hex_files(argv[1])) {
+        std::vector<uint8_t> bytes;
+        if (CHECK(read_hex(path, bytes))) corpus.push_back(bytes);
+    }
+    CHECK(!corpus.empty());
+    for (const std::vector<uint8_t>& input : corpus) run_one(buf, input);
+    // Every seed decodes; mutations are free to be rejected.
+    CHECK(g_accepted == corpus.size());
+
+    std::mt19937 rng(20240611);
+    for (unsigned long i = 0; i < iters && !corpus.empty(); ++i) {
+        std::vector<uint8_t> b = corpus[rng() % corpus.size()];
+        for (unsigned n = 1 + rng() % 3; n; --n) mutate(b, rng);
+        run_one(buf, b);
+    }
+    std::printf("netplay_export_fuzz: %zu corpus files, %lu mutations, %lu decoded\n", corpus.size(), iters, g_accepted);
+    return efzda_test::check_result("netplay_export_fuzz");
+}
@@ -0,0 +1,142 @@
+#pragma once
+// Well-formed efz_netplay_mod export blocks for every layout the decoder
+// knows, shared by the netplay_export test, fuzzer and benchmark.
+#include "efz_netplay_state.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace efzda_test {
+
+struct ExportSeed {
+    std::string name;
+    std::vector<uint8_t> bytes;
+};
+
+inline void put_u32(std::vector<uint8_t>& b, size_t at, uint32_t v) {
+    std::memcpy(b.data() + at, &v, sizeof(v));
+}
+
+inline void put_str(std::vector<uint8_t>& b, size_t at, const char* s) {
+    std::memcpy(b.data() + at, s, std::strlen(s));
+}
+
+// A v7 export in a live online match, every capability populated.
+inline EFZNetplayState v7_match_state() {
+    EFZNetplayState s;
+    std::memset(&s, 0, sizeof(s));
+    s.magic = EFZ_NETPLAY_STATE_MAGIC;
+    s.version = 7;
+    s.structSize = sizeof(EFZNetplayState);
+    s.lastUpdateTick = 123456;
+    s.sessionMode = EFZ_SESSION_HOSTING;
+    s.sessionPhase = EFZ_PHASE_CONNECTED;
+    s.localSide = 0;
+    s.p1Wins = 1;
+    s.p2Wins = 2;
+    s.matchCounter = 3;
+    std::strcpy(s.localNickname, "Host");
+    std::strcpy(s.p1Name, "Host");
+    std::strcpy(s.p2Name, "Guest");
+    s.pingMs = 42;
+    s.rollbackFrames = 2;
+    std::strcpy(s.revivalVersion, "1.02i");
+    s.inNetplayMatch = 1;
+    s.capabilityFlags = 0x1FFF;
+    s.stateSeq = 77;
+    s.sessionId = 5;
+    s.setId = 9;
+    s.activityPhase = EFZ_ACTIVITY_MATCH;
+    s.endReason = EFZ_END_NONE;
+    s.p1CharId = 3;
+    s.p2CharId = 11;
+    s.p1Locked = 1;
+    s.p2Locked = 1;
+    s.localCursorCharId = 3;
+    s.stageId = 4;
+    s.roundIndex = 1;
+    s.isRoundActive = 1;
+    s.roundTimerFrames = 5400;
+    s.asyncHostActive = 1;
+    s.hostPort = 7500;
+    s.avgPingMs = 40;
+    s.minPingMs = 30;
+    s.maxPingMs = 60;
+    s.recommendedDelay = 2;
+    s.minDelay = 1;
+    s.maxDelay = 4;
+    std::strcpy(s.connectionAddress, "203.0.113.7:7500");
+    return s;
+}
+
+inline std::vector<uint8_t> bytes_of(const EFZNetplayState& s, size_t size) {
+    std::vector<uint8_t> b(size, 0);
+    std::memcpy(b.data(), &s, size < sizeof(s) ? size : sizeof(s));
+    put_u32(b, 8, static_cast<uint32_t>(size));
+    return b;
+}
+
+// v2-v4 block (32-byte localNickname, legacy menu screen numbering).
+inline std::vector<uint8_t> v4_menu_block() {
+    std::vector<uint8_t> b(268, 0);
+    put_u32(b, 0, EFZ_NETPLAY_STATE_MAGIC);
+    put_u32(b, 4, 4);
+    put_u32(b, 8, static_cast<uint32_t>(b.size()));
+    put_u32(b, 12, 1000);                 // lastUpdateTick
+    put_str(b, 40, "Old");                // localNickname[32]
+    put_u32(b, 200, static_cast<uint32_t>(-1)); // pingMs
+    put_u32(b, 204, static_cast<uint32_t>(-1)); // rollbackFrames
+    b[208] = 1;                           // inNetplayMenu
+    b[209] = 3;                           // legacy Nickname screen
+    put_str(b, 212, "1.02e");             // revivalVersion
+    put_u32(b, 232, 0x3FF);               // capabilityFlags
+    put_u32(b, 236, 12);                  // stateSeq
+    b[248] = EFZ_ACTIVITY_MENU;
+    return b;
+}
+
+// Legacy v1 block without lastUpdateTick, at the minimum accepted size.
+inline std::vector<uint8_t> v1_block() {
+    std::vector<uint8_t> b(204, 0);
+    put_u32(b, 0, EFZ_NETPLAY_STATE_MAGIC);
+    put_u32(b, 4, 1);
+    put_u32(b, 8, static_cast<uint32_t>(b.size()));
+    put_u32(b, 12, EFZ_SESSION_JOINING);  // sessionMode
+    put_u32(b, 16, EFZ_PHASE_CONNECTING); // sessionPhase
+    put_str(b, 36, "Legacy");             // localNickname
+    put_u32(b, 196, 80);                  // pingMs
+    put_u32(b, 200, 3);                   // rollbackFrames
+    return b;
+}
+
+inline std::vector<ExportSeed> export_seeds() {
+    EFZNetplayState s = v7_match_state();
+    std::vector<ExportSeed> seeds;
+    seeds.push_back({"v7_match", bytes_of(s, sizeof(s))});
+    EFZNetplayState capsOff = s;
+    capsOff.capabilityFlags &= ~(EFZ_CAP_ASYNC_HOST | EFZ_CAP_NET_DETAIL | EFZ_CAP_CONNECTION);
+    seeds.push_back({"v7_caps_off", bytes_of(capsOff, sizeof(capsOff))});
+    EFZNetplayState menu = s;
+    menu.version = 6;
+    menu.inNetplayMatch = 0;
+    menu.inNetplayMenu = 1;
+    menu.netplayMenuScreen = EFZ_MENU_BATTLE_LOG;
+    menu.netplayMenuDetail = EFZ_MENU_DETAIL_BATTLE_LOG_BROWSER;
+    menu.activityPhase = EFZ_ACTIVITY_MENU;
+    seeds.push_back({"v6_menu", bytes_of(menu, offsetof(EFZNetplayState, asyncHostActive))});
+    // Truncated in the middle of the v7 groups and of connectionAddress.
+    seeds.push_back({"v7_cut_net_detail", bytes_of(s, offsetof(EFZNetplayState, avgPingMs) + 6)});
+    seeds.push_back({"v7_cut_connection", bytes_of(s, offsetof(EFZNetplayState, connectionAddress) + 8)});
+    // A future version that only appended fields.
+    EFZNetplayState future = s;
+    future.version = 9;
+    seeds.push_back({"v9_longer", bytes_of(future, sizeof(future) + 64)});
+    seeds.push_back({"v4_menu", v4_menu_block()});
+    seeds.push_back({"v1_min", v1_block()});
+    return seeds;
+}
+
+} // namespace efzda_test
@@ -0,0 +1,126 @@
+// parse_netplay_export_state() on every layout: field values, size and
+// capability gating, legacy menu numbering and rejected headers.
+#include "check.h"
+#include "netplay_export_seeds.h"
+
+#include "state/netplay_export.h"
+
+#include <cstddef>
+
+using namespace efzda;
+using namespace efzda_test;
+
+namespace {
+
+void test_v7_full() {
+    const EFZNetplayState s = v7_match_state();
+    NetplayExportState out;
+    CHECK(parse_netplay_export_state(&s, out));
+    CHECK(out.valid && out.version == 7 && out.structSize == sizeof(EFZNetplayState));
+    CHECK(out.lastUpdateTick == 123456);
+    CHECK(out.sessionMode == EFZ_SESSION_HOSTING && out.sessionPhase == EFZ_PHASE_CONNECTED && out.localSide == 0);
+    CHECK(out.p1Wins == 1 && out.p2Wins == 2 && out.matchCounter == 3);
+    CHECK(out.localNickname == "Host" && out.p1Name == "Host" && out.p2Name == "Guest");
+    CHECK(out.pingMs == 42 && out.rollbackFrames == 2);
+    CHECK(out.revivalVersion == "1.02i");
+    CHECK(out.inNetplayMatch && !out.inNetplayMenu && !out.inNetplayCharacterSelect);
+    CHECK(out.hasCapabilityFlags && out.capabilityFlags == 0x1FFF);
+    CHECK(out.stateSeq == 77 && out.sessionId == 5 && out.setId == 9);
+    CHECK(out.hasActivityPhase && out.activityPhase == EFZ_ACTIVITY_MATCH);
+    CHECK(out.hasEndReason && out.endReason == EFZ_END_NONE);
+    CHECK(out.hasCharSelectContext && out.p1CharId == 3 && out.p2CharId == 11 && out.p1Locked && out.p2Locked);
+    CHECK(out.hasMatchContext && out.stageId == 4 && out.roundIndex == 1 && out.isRoundActive && out.roundTimerFrames == 5400);
+    CHECK(out.hasAsyncHost && out.asyncHostActive && out.hostPort == 7500);
+    CHECK(out.hasNetDetail && out.avgPingMs == 40 && out.minDelay == 1 && out.maxDelay == 4);
+    CHECK(out.hasConnection && out.connectionAddress == "203.0.113.7:7500");
+
+    size_t seq = 0;
+    CHECK(netplay_export_seq_offset(7, sizeof(EFZNetplayState), seq));
+    CHECK(seq == offsetof(EFZNetplayState, stateSeq));
+}
+
+void test_v7_gating() {
+    for (const ExportSeed& seed : export_seeds()) {
+        NetplayExportState out;
+        CHECK(parse_netplay_export_state(seed.bytes.data(), out));
+        if (seed.name == "v7_caps_off") {
+            // Groups gated on a capability bit stay off even though they fit.
+            CHECK(!out.hasAsyncHost && !out.hasNetDetail && !out.hasConnection);
+            CHECK(out.hostPort == 0 && out.avgPingMs == -1 && out.connectionAddress.empty());
+            CHECK(out.hasMatchContext);
+        } else if (seed.name == "v6_menu") {
+            CHECK(out.inNetplayMenu && out.netplayMenuScreen == EFZ_MENU_BATTLE_LOG);
+            CHECK(out.netplayMenuDetail == EFZ_MENU_DETAIL_BATTLE_LOG_BROWSER);
+            CHECK(out.hasMatchContext && !out.hasAsyncHost);
+        } else if (seed.name == "v7_cut_net_detail") {
+            // A group is decoded only when it fits whole.
+            CHECK(out.hasAsyncHost && !out.hasNetDetail && out.avgPingMs == -1);
+        } else if (seed.name == "v7_cut_connection") {
+            CHECK(out.hasNetDetail && !out.hasConnection);
+        } else if (seed.name == "v9_longer") {
+            CHECK(out.version == 9 && out.hasConnection && out.connectionAddress == "203.0.113.7:7500");
+        }
+    }
+}
+
+void test_v4_and_v1() {
+    const std::vector<uint8_t> v4 = v4_menu_block();
+    NetplayExportState out;
+    CHECK(parse_netplay_export_state(v4.data(), out));
+    CHECK(out.version == 4 && out.lastUpdateTick == 1000);
+    CHECK(out.localNickname == "Old");
+    CHECK(out.inNetplayMenu && out.netplayMenuScreen == EFZ_MENU_OPTIONS); // legacy 3
+    CHECK(out.netplayMenuDetail == EFZ_MENU_DETAIL_NONE);
+    CHECK(out.revivalVersion == "1.02e");
+    CHECK(out.hasCapabilityFlags && out.stateSeq == 12);
+    CHECK(out.hasActivityPhase && out.activityPhase == EFZ_ACTIVITY_MENU);
+    CHECK(out.hasCharSelectContext && out.hasMatchContext && !out.hasAsyncHost);
+    size_t seq = 0;
+    CHECK(netplay_export_seq_offset(4, 268, seq) && seq == 236);
+
+    const std::vector<uint8_t> v1 = v1_block();
+    CHECK(parse_netplay_export_state(v1.data(), out));
+    CHECK(out.version == 1 && out.lastUpdateTick == 0);
+    CHECK(out.sessionMode == EFZ_SESSION_JOINING && out.sessionPhase == EFZ_PHASE_CONNECTING);
+    CHECK(out.localNickname == "Legacy" && out.pingMs == 80 && out.rollbackFrames == 3);
+    // Menu and version fields lie past the 204-byte minimum.
+    CHECK(!out.inNetplayMenu && out.revivalVersion.empty() && !out.hasCapabilityFlags);
+    CHECK(!netplay_export_seq_offset(1, 204, seq));
+}
+
+void test_rejects() {
+    NetplayExportState out;
+    CHECK(!parse_netplay_export_state(nullptr, out));
+    CHECK(!out.valid);
+
+    EFZNetplayState s = v7_match_state();
+    s.magic ^= 1;
+    CHECK(!parse_netplay_export_state(&s, out));
+    s = v7_match_state();
+    s.structSize = EFZ_NETPLAY_STATE_LEGACY_MIN_V1_SIZE - 1;
+    CHECK(!parse_netplay_export_state(&s, out));
+    s.structSize = 4097;
+    CHECK(!parse_netplay_export_state(&s, out));
+    size_t seq = 0;
+    CHECK(!netplay_export_seq_offset(7, 4097, seq));
+
+    // Control characters are dropped from strings, not passed on.
+    s = v7_match_state();
+    std::strcpy(s.p2Name, "Gu\x01""e\ns\tt");
+    CHECK(parse_netplay_export_state(&s, out));
+    CHECK(out.p2Name == "Guest");
+    // Unterminated strings stop at the field size.
+    std::memset(s.p1Name, 'A', sizeof(s.p1Name));
+    CHECK(parse_netplay_export_state(&s, out));
+    CHECK(out.p1Name.size() == sizeof(s.p1Name) && out.p2Name == "Guest");
+}
+
+} // namespace
+
+int main() {
+    test_v7_full();
+    test_v7_gating();
+    test_v4_and_v1();
+    test_rejects();
+    return efzda_test::check_result("netplay_export_test");
+}
@@ -0,0 +1,41 @@
+// Flow resolution over a randomized input stream: the precomputed table
+// against evaluating the rules each time. --dump writes the table as CSV
+// to stdout instead.
+#include "check.h"
+
+#include "state/netplay_flow.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace efzda;
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--dump") == 0) return write_netplay_flow_table(stdout) ? 0 : 1;
+    }
+    const unsigned long iters = efzda_test::quick_run(argc, argv) ? 10000 : 10000000;
+
+    std::mt19937 rng(1234);
+    std::vector<NetplayFlowInputs> stream(4096);
+    for (NetplayFlowInputs& in : stream) {
+        uint16_t key = static_cast<uint16_t>(rng());
+        key = static_cast<uint16_t>((key & ~0xFu) | (rng() % kNetplayFlowCount));
+        in = netplay_flow_inputs(key);
+    }
+
+    resolve_netplay_flow(stream[0]); // build the table outside the timing
+    size_t i = 0;
+    unsigned flows = 0;
+    efzda_test::bench("table lookup", iters, [&] {
+        flows += static_cast<unsigned>(resolve_netplay_flow(stream[i++ & 4095]).flow);
+    });
+    efzda_test::bench("rule evaluation", iters, [&] {
+        flows += static_cast<unsigned>(evaluate_netplay_flow_rules(stream[i++ & 4095]).flow);
+    });
+    efzda_test::keep(flows);
+    return 0;
+}
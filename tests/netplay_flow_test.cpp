@@ -0,0 +1,112 @@
+// Netplay flow table: key packing, table vs rules over every key, and the
+// exhaustive CSV dump.
+#include "check.h"
+
+#include "state/netplay_flow.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace efzda;
+
+namespace {
+
+void test_key_round_trip() {
+    unsigned mismatches = 0;
+    for (unsigned key = 0; key < kNetplayFlowKeyCount; ++key) {
+        const NetplayFlowInputs in = netplay_flow_inputs(static_cast<uint16_t>(key));
+        if (netplay_flow_key(in) != key) ++mismatches;
+    }
+    CHECK(mismatches == 0);
+}
+
+void test_table_matches_rules() {
+    unsigned mismatches = 0;
+    bool seen[kNetplayFlowRuleCount] = {};
+    for (unsigned key = 0; key < kNetplayFlowKeyCount; ++key) {
+        const NetplayFlowInputs in = netplay_flow_inputs(static_cast<uint16_t>(key));
+        const NetplayFlowDecision t = resolve_netplay_flow(in);
+        const NetplayFlowDecision r = evaluate_netplay_flow_rules(in);
+        if (t.flow != r.flow || t.rule != r.rule) ++mismatches;
+        if (static_cast<unsigned>(r.rule) < kNetplayFlowRuleCount) seen[static_cast<unsigned>(r.rule)] = true;
+    }
+    CHECK(mismatches == 0);
+    // ConnectedGameplay is shadowed: LocalContext already replaces every
+    // menu claim it would match. Every other rule must be reachable.
+    for (unsigned i = 0; i < kNetplayFlowRuleCount; ++i) {
+        const NetplayFlowRule rule = static_cast<NetplayFlowRule>(i);
+        const bool expected = rule != NetplayFlowRule::ConnectedGameplay;
+        if (!CHECK(seen[i] == expected))
+            std::fprintf(stderr, "  rule %s: reachable=%d\n", netplay_flow_rule_name(rule), seen[i] ? 1 : 0);
+    }
+}
+
+void test_rules() {
+    NetplayFlowInputs in;
+    in.claim = NetplayFlow::Menu;
+    in.activityPhase = true;
+    in.titleScreen = FlowTitleScreen::Title;
+    NetplayFlowDecision d = resolve_netplay_flow(in);
+    CHECK(d.flow == NetplayFlow::Menu && d.rule == NetplayFlowRule::Claimed);
+
+    // Menu claimed while the game sits in character select of an active session.
+    in.sessionActive = true;
+    in.titleScreen = FlowTitleScreen::NotTitle;
+    in.localScreen = FlowLocalScreen::CharSelect;
+    d = resolve_netplay_flow(in);
+    CHECK(d.flow == NetplayFlow::CharSelect && d.rule == NetplayFlowRule::HardOverride);
+
+    // Nothing local to map, but connected: loading.
+    in.localScreen = FlowLocalScreen::Other;
+    in.connected = true;
+    d = resolve_netplay_flow(in);
+    CHECK(d.flow == NetplayFlow::Loading && d.rule == NetplayFlowRule::HardOverrideLoading);
+
+    // Legacy export (no activity phase) claiming the menu off the title screen.
+    NetplayFlowInputs legacy;
+    legacy.claim = NetplayFlow::Menu;
+    legacy.titleScreen = FlowTitleScreen::NotTitle;
+    d = resolve_netplay_flow(legacy);
+    CHECK(d.flow == NetplayFlow::None && d.rule == NetplayFlowRule::NotTitle);
+
+    legacy.idleNoFlow = true;
+    d = resolve_netplay_flow(legacy);
+    CHECK(d.flow == NetplayFlow::None && d.rule == NetplayFlowRule::IdleNoFlow);
+
+    NetplayFlowInputs conflict;
+    conflict.claim = NetplayFlow::Match;
+    conflict.claimConflict = true;
+    d = resolve_netplay_flow(conflict);
+    CHECK(d.flow == NetplayFlow::Match && d.rule == NetplayFlowRule::ExplicitFlags);
+}
+
+void test_dump() {
+    std::FILE* f = std::tmpfile();
+    CHECK(f != nullptr);
+    if (!f) return;
+    const size_t rows = write_netplay_flow_table(f);
+    CHECK(rows == kNetplayFlowCount * (kNetplayFlowKeyCount / 16));
+    std::rewind(f);
+    char line[256];
+    size_t lines = 0;
+    std::string header;
+    while (std::fgets(line, sizeof(line), f)) {
+        if (lines == 0) header = line;
+        ++lines;
+    }
+    CHECK(lines == rows + 1);
+    CHECK(header.compare(0, 10, "key,claim,") == 0);
+    std::fclose(f);
+    CHECK(write_netplay_flow_table(nullptr) == 0);
+}
+
+} // namespace
+
+int main() {
+    test_key_round_trip();
+    test_table_matches_rules();
+    test_rules();
+    test_dump();
+    return efzda_test::check_result("netplay_flow_test");
+}
@@ -0,0 +1,72 @@
+// GameStateProvider::get() stage by stage (Sample, Resolve, Classify,
+// Format; see StageTimings) and materialize(), over a recorded session
+// (replay_session.h) replayed with the fingerprint short-circuit off, so
+// every poll runs all four stages.
+#include "check.h"
+#include "replay_session.h"
+
+#include "state/game_state_provider.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace efzda {
+void log(const char*, ...) {}
+void logw(const wchar_t*, ...) {}
+} // namespace efzda
+
+using namespace efzda;
+
+namespace {
+
+void print_stage(const char* name, uint64_t totalNs, unsigned long polls) {
+    std::printf("%-40s %10lu polls %12.1f ns/op\n", name, polls,
+                polls ? static_cast<double>(totalNs) / static_cast<double>(polls) : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned long replays = efzda_test::quick_run(argc, argv) ? 2 : 200;
+    setenv("EFZDA_FINGERPRINT_MAX_AGE_MS", "0", 1);
+
+    char dir[] = "/tmp/efzda-stages-XXXXXX";
+    if (!::mkdtemp(dir)) return 1;
+    const std::string path = std::string(dir) + "/session.efzsnap";
+    if (!efzda_test::write_replay_session(path, 100)) return 1;
+
+    GameStateProvider provider;
+    std::vector<ReplayedPoll> timeline;
+    if (!provider.replay(path, timeline)) return 1; // warm up
+
+    StageTimings total;
+    unsigned long polls = 0;
+    for (unsigned long r = 0; r < replays; ++r) {
+        provider.replay(path, timeline);
+        for (const ReplayedPoll& p : timeline) {
+            total.sampleNs += p.stages.sampleNs;
+            total.resolveNs += p.stages.resolveNs;
+            total.classifyNs += p.stages.classifyNs;
+            total.formatNs += p.stages.formatNs;
+        }
+        polls += static_cast<unsigned long>(timeline.size());
+    }
+    print_stage("sample (reads, export, fingerprint)", total.sampleNs, polls);
+    print_stage("resolve", total.resolveNs, polls);
+    print_stage("classify", total.classifyNs, polls);
+    print_stage("format (GameState)", total.formatNs, polls);
+    print_stage("get() total", total.sampleNs + total.resolveNs + total.classifyNs + total.formatNs, polls);
+
+    size_t i = 0;
+    efzda_test::bench("materialize()", polls, [&] {
+        efzda_test::keep(provider.materialize(timeline[i++ % timeline.size()].state).details.size());
+    });
+
+    ::unlink(path.c_str());
+    ::rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,110 @@
+// ActivityRateLimiter on a simulated millisecond clock: bursts of presence
+// updates must never put more than `burst` sends in any window, and must
+// never be held back while the window has room.
+#include "check.h"
+
+#include "discord/rate_limiter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <random>
+
+using namespace efzda;
+
+namespace {
+
+void test_basics() {
+    ActivityRateLimiter rl; // 5 per 20 s
+    for (uint32_t i = 0; i < kActivityBurst; ++i) {
+        CHECK(rl.waitMs(1000 + i) == 0);
+        rl.take(1000 + i);
+    }
+    CHECK(rl.available(1005) == 0);
+    CHECK(rl.waitMs(1005) == 1000 + kActivityWindowMs - 1005); // first spend ages out
+    CHECK(rl.waitMs(1005, 2) == 1001 + kActivityWindowMs - 1005);
+    CHECK(rl.waitMs(1000 + kActivityWindowMs) == 0);
+    CHECK(rl.available(1000 + kActivityWindowMs) == 1);
+    CHECK(rl.available(1004 + kActivityWindowMs) == kActivityBurst);
+
+    // Asking for more than the burst is capped at the burst.
+    CHECK(rl.waitMs(50000, 100) == 0);
+
+    // Burst is clamped to 1..16.
+    ActivityRateLimiter one(0, 1000);
+    CHECK(one.available(0) == 1);
+    one.take(0);
+    CHECK(one.waitMs(10) == 990);
+    ActivityRateLimiter big(100, 1000);
+    CHECK(big.available(0) == 16);
+
+    // Taking over budget forgets the oldest spend instead of overflowing.
+    ActivityRateLimiter over(2, 1000);
+    over.take(0);
+    over.take(100);
+    over.take(200);
+    CHECK(over.available(200) == 0);
+    CHECK(over.waitMs(200) == 100 + 1000 - 200);
+}
+
+// One simulated session: updates arrive in bursts separated by quiet gaps
+// and are sent (latest only, like the writer thread) as soon as the limiter
+// allows.
+void test_simulated_bursts(uint32_t burst, uint32_t windowMs, unsigned seed) {
+    ActivityRateLimiter rl(burst, windowMs);
+    std::mt19937 rng(seed);
+    std::deque<uint64_t> sent; // send times inside the current window
+    uint64_t pendingSince = 0;
+    bool pending = false;
+    uint64_t sends = 0, updates = 0, maxWait = 0;
+    unsigned overfull = 0, heldWithRoom = 0, lateWake = 0;
+
+    uint64_t nextUpdate = 0;
+    uint64_t wakeAt = 0;
+    const uint64_t endMs = 30ull * 60 * 1000; // half an hour of play
+    for (uint64_t now = 0; now < endMs; ++now) {
+        if (now == nextUpdate) {
+            ++updates;
+            if (!pending) pendingSince = now;
+            pending = true;
+            // Mostly a flurry of changes (menus, char select), sometimes a long match.
+            nextUpdate = now + (rng() % 4 ? 50 + rng() % 400 : 5000 + rng() % 60000);
+        }
+        while (!sent.empty() && now - sent.front() >= windowMs) sent.pop_front();
+        if (!pending) continue;
+        const uint64_t wait = rl.waitMs(now);
+        if (wait == 0) {
+            if (wakeAt && now > wakeAt) ++lateWake;
+            rl.take(now);
+            sent.push_back(now);
+            ++sends;
+            if (sent.size() > burst) ++overfull;
+            maxWait = (std::max)(maxWait, now - pendingSince);
+            pending = false;
+            wakeAt = 0;
+        } else {
+            if (sent.size() < burst) ++heldWithRoom;
+            // The writer sleeps for the returned wait; it must be enough.
+            if (!wakeAt) wakeAt = now + wait;
+        }
+    }
+    std::printf("rate_limiter %u/%u ms: %llu updates, %llu sends, longest hold %llu ms\n", burst, windowMs,
+                static_cast<unsigned long long>(updates), static_cast<unsigned long long>(sends),
+                static_cast<unsigned long long>(maxWait));
+    CHECK(sends > 0);
+    CHECK(overfull == 0);     // never more than `burst` in any window
+    CHECK(heldWithRoom == 0); // never throttled with room left
+    CHECK(lateWake == 0);     // waitMs() never under-reports
+    CHECK(maxWait <= windowMs);
+}
+
+} // namespace
+
+int main() {
+    test_basics();
+    test_simulated_bursts(kActivityBurst, kActivityWindowMs, 1);
+    test_simulated_bursts(kActivityBurst, kActivityWindowMs, 2);
+    test_simulated_bursts(1, 4000, 3);
+    test_simulated_bursts(16, 60000, 4);
+    return efzda_test::check_result("rate_limiter_test");
+}
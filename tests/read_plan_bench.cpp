@@ -0,0 +1,83 @@
+// Per-field reads vs one ReadPlan execute over the poll's field set, on
+// FakeMemorySource (every read counts as one simulated syscall).
+#include "check.h"
+
+#include "memory/memory_source.h"
+#include "memory/read_plan.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace efzda;
+
+int main(int argc, char** argv) {
+    const unsigned long iters = efzda_test::quick_run(argc, argv) ? 1000 : 200000;
+    constexpr uintptr_t kEfzBase = 0x400000;
+    constexpr uintptr_t kRevivalBase = 0x10000000;
+    constexpr uintptr_t kChar[2] = {0x2000000, 0x2100000};
+
+    FakeMemorySource mem;
+    mem.map(kEfzBase + 0x390000, 0x1000);
+    mem.map(kRevivalBase, 0x1000);
+    for (int i = 0; i < 2; ++i) {
+        mem.map(kChar[i], 0x1000);
+        mem.writeValue<uintptr_t>(kEfzBase + 0x390104 + 4 * i, kChar[i]);
+    }
+
+    // The live poll's shape: slots, screen, game mode, names, scores, nicknames.
+    struct Field {
+        bool indirect;
+        int slot;
+        ReadRoot root;
+        uintptr_t offset;
+        uint32_t size;
+    };
+    const std::vector<Field> fields = {
+        {false, 0, ReadRoot::Efz, 0x390104, sizeof(uintptr_t)},
+        {false, 0, ReadRoot::Efz, 0x390108, sizeof(uintptr_t)},
+        {false, 0, ReadRoot::Efz, 0x39010C, 4},
+        {false, 0, ReadRoot::Efz, 0x390148, 1},
+        {true, 0, ReadRoot::Efz, 0x94, 12},
+        {true, 1, ReadRoot::Efz, 0x94, 12},
+        {false, 0, ReadRoot::Revival, 0x4C8, 4},
+        {false, 0, ReadRoot::Revival, 0x4CC, 4},
+        {false, 0, ReadRoot::Revival, 0x3BE, 52},
+        {false, 0, ReadRoot::Revival, 0x43E, 52},
+        {false, 0, ReadRoot::Revival, 0x2A8, 4},
+        {false, 0, ReadRoot::Revival, 0x2FC, 4},
+        {false, 0, ReadRoot::Revival, 0x300, 4},
+    };
+
+    ReadPlanBuilder b;
+    const ReadFieldId slots[2] = {b.add<uintptr_t>(ReadRoot::Efz, 0x390104), b.add<uintptr_t>(ReadRoot::Efz, 0x390108)};
+    for (const Field& f : fields) {
+        if (f.indirect) b.addIndirect(slots[f.slot], f.offset, f.size);
+        else b.add(f.root, f.offset, f.size);
+    }
+    const ReadPlan plan = b.compile();
+    const uintptr_t roots[kReadRootCount] = {kEfzBase, kRevivalBase};
+
+    uint8_t buf[64];
+    mem.resetStats();
+    efzda_test::bench("per-field reads", iters, [&] {
+        for (const Field& f : fields) {
+            const uintptr_t base = f.indirect ? kChar[f.slot] : (f.root == ReadRoot::Efz ? kEfzBase : kRevivalBase);
+            mem.read(base + f.offset, buf, f.size);
+        }
+        efzda_test::keep(buf[0]);
+    });
+    const uint32_t perFieldCalls = mem.stats().syscalls / static_cast<uint32_t>(iters);
+
+    ReadPlanResult r;
+    mem.resetStats();
+    efzda_test::bench("read plan execute", iters, [&] {
+        plan.execute(mem, roots, r);
+        efzda_test::keep(r.spansRead());
+    });
+    const uint32_t planCalls = mem.stats().syscalls / static_cast<uint32_t>(iters);
+
+    std::printf("reads per poll: %u per-field, %u with the plan (%zu spans, %u bytes)\n",
+                (unsigned)perFieldCalls, (unsigned)planCalls, plan.spanCount(), (unsigned)plan.bufferSize());
+    return planCalls < perFieldCalls ? 0 : 1;
+}
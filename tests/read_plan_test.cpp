@@ -0,0 +1,129 @@
+// ReadPlanBuilder / ReadPlan / ReadPlanOverlay against FakeMemorySource.
+#include "check.h"
+
+#include "memory/memory_source.h"
+#include "memory/read_plan.h"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace efzda;
+
+namespace {
+
+constexpr uintptr_t kEfzBase = 0x400000;
+constexpr uintptr_t kRevivalBase = 0x10000000;
+constexpr uintptr_t kCharP1 = 0x2000000;
+
+void test_coalescing() {
+    ReadPlanBuilder b;
+    const ReadFieldId p1 = b.add<uintptr_t>(ReadRoot::Efz, 0x390104);
+    const ReadFieldId p2 = b.add<uintptr_t>(ReadRoot::Efz, 0x390108);
+    const ReadFieldId screen = b.add<uint8_t>(ReadRoot::Efz, 0x390148);
+    const ReadFieldId far = b.add<uint8_t>(ReadRoot::Efz, 0x39F000);
+    const ReadFieldId wins = b.add<int32_t>(ReadRoot::Revival, 0x4C8);
+    CHECK(b.add<uintptr_t>(ReadRoot::Efz, 0x390104) == p1); // folded
+    ReadPlanOptions opt;
+    opt.maxGap = 256;
+    const ReadPlan plan = b.compile(opt);
+    CHECK(plan.fieldCount() == 5);
+    // p1/p2/screen share a span; far and the Revival field stand alone.
+    CHECK(plan.spanCount() == 3);
+
+    FakeMemorySource mem;
+    mem.map(kEfzBase + 0x390000, 0x10000);
+    mem.map(kRevivalBase, 0x1000);
+    mem.writeValue<uintptr_t>(kEfzBase + 0x390104, kCharP1);
+    mem.writeValue<uintptr_t>(kEfzBase + 0x390108, 0);
+    mem.writeValue<uint8_t>(kEfzBase + 0x390148, 7);
+    mem.writeValue<int32_t>(kRevivalBase + 0x4C8, 3);
+    const uintptr_t roots[kReadRootCount] = {kEfzBase, kRevivalBase};
+    ReadPlanResult r;
+    mem.resetStats();
+    plan.execute(mem, roots, r);
+    CHECK(mem.stats().syscalls == 3);
+    uintptr_t v = 0;
+    uint8_t s = 0;
+    int32_t w = 0;
+    CHECK(r.get(p1, v) && v == kCharP1);
+    CHECK(r.get(p2, v) && v == 0);
+    CHECK(r.get(screen, s) && s == 7);
+    CHECK(r.get(wins, w) && w == 3);
+    CHECK(r.valid(far));
+    CHECK(!r.get(screen, w)); // wrong size
+    CHECK(r.address(screen) == kEfzBase + 0x390148);
+}
+
+void test_indirect_and_failures() {
+    ReadPlanBuilder b;
+    const ReadFieldId p1 = b.add<uintptr_t>(ReadRoot::Efz, 0x390104);
+    const ReadFieldId name = b.addIndirect(p1, 0x94, 12);
+    const ReadFieldId hp = b.addIndirect<int16_t>(p1, 0x100);
+    CHECK(b.addIndirect<int16_t>(name, 0) == kInvalidReadField); // parent is not a pointer
+    const ReadPlan plan = b.compile();
+    CHECK(plan.spanCount() == 2);
+
+    FakeMemorySource mem;
+    mem.map(kEfzBase + 0x390000, 0x1000);
+    const uintptr_t roots[kReadRootCount] = {kEfzBase, 0};
+    ReadPlanResult r;
+
+    // Null pointer: the hop is unresolved and its fields stay invalid.
+    plan.execute(mem, roots, r);
+    CHECK(r.valid(p1));
+    CHECK(!r.valid(name) && !r.valid(hp));
+    CHECK(r.address(name) == 0);
+
+    // Pointer to a block that holds the name but not hp: the coalesced span
+    // fails and the per-field retry recovers the name only.
+    mem.writeValue<uintptr_t>(kEfzBase + 0x390104, kCharP1);
+    mem.map(kCharP1, 0xA0);
+    mem.write(kCharP1 + 0x94, "Akane\0\0\0\0\0\0\0", 12);
+    plan.execute(mem, roots, r);
+    CHECK(r.spansFailed() == 1);
+    CHECK(r.valid(name) && !r.valid(hp));
+    CHECK(std::memcmp(r.bytes(name), "Akane", 6) == 0);
+    char out[4];
+    CHECK(r.lookup(kCharP1 + 0x95, out, 4));
+    CHECK(!r.lookup(kCharP1 + 0x9E, out, 4)); // crosses into the failed field
+}
+
+void test_overlay_and_fingerprint() {
+    ReadPlanBuilder b;
+    const ReadFieldId screen = b.add<uint8_t>(ReadRoot::Efz, 0x390148);
+    b.add<uint32_t>(ReadRoot::Efz, 0x390150);
+    const ReadPlan plan = b.compile();
+    FakeMemorySource mem;
+    mem.map(kEfzBase + 0x390000, 0x1000);
+    const uintptr_t roots[kReadRootCount] = {kEfzBase, 0};
+    ReadPlanResult r;
+    plan.execute(mem, roots, r);
+    const uint64_t before = r.fingerprint();
+
+    ReadPlanOverlay overlay(r, mem);
+    uint8_t s = 0xFF;
+    uint32_t gap = 1;
+    mem.resetStats();
+    CHECK(overlay.read(kEfzBase + 0x390148, &s, 1) && s == 0);
+    CHECK(overlay.read(kEfzBase + 0x39014C, &gap, 4)); // inside the span, between fields
+    CHECK(overlay.hits() == 2 && mem.stats().reads == 0);
+    CHECK(overlay.read(kEfzBase + 0x390800, &gap, 4)); // falls through
+    CHECK(mem.stats().reads == 1);
+
+    mem.writeValue<uint8_t>(kEfzBase + 0x390148, 3);
+    plan.execute(mem, roots, r);
+    CHECK(r.valid(screen));
+    CHECK(r.fingerprint() != before);
+    mem.writeValue<uint8_t>(kEfzBase + 0x390148, 0);
+    plan.execute(mem, roots, r);
+    CHECK(r.fingerprint() == before);
+}
+
+} // namespace
+
+int main() {
+    test_coalescing();
+    test_indirect_and_failures();
+    test_overlay_and_fingerprint();
+    return efzda_test::check_result("read_plan_test");
+}
@@ -0,0 +1,35 @@
+// RegionMapMemorySource throughput: cached lookups + memcpy, against a map
+// that is rebuilt for every read (what a query-per-read source costs).
+#include "check.h"
+
+#include "memory/region_map.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace efzda;
+
+int main(int argc, char** argv) {
+    const bool quick = efzda_test::quick_run(argc, argv);
+    std::vector<uint8_t> block(1 << 16, 1);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(block.data());
+    uint32_t value = 0;
+    unsigned i = 0;
+
+    RegionMapMemorySource cached(std::chrono::milliseconds(0)); // never expires
+    efzda_test::bench("cached 4-byte read", quick ? 10000 : 10000000, [&] {
+        cached.read(base + (i++ * 64 & 0xFFFF), &value, sizeof(value));
+        efzda_test::keep(value);
+    });
+    std::printf("  queries: %u\n", (unsigned)cached.regions().queries());
+
+    RegionMapMemorySource cold(std::chrono::milliseconds(0));
+    efzda_test::bench("4-byte read, map rebuilt each time", quick ? 100 : 20000, [&] {
+        cold.regions().invalidate();
+        cold.read(base + (i++ * 64 & 0xFFFF), &value, sizeof(value));
+        efzda_test::keep(value);
+    });
+    std::printf("  queries: %u\n", (unsigned)cold.regions().queries());
+    return 0;
+}
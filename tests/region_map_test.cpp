@@ -0,0 +1,85 @@
+// RegionMap and RegionMapMemorySource on the POSIX backend (/proc/self/maps).
+#include "check.h"
+
+#include "memory/region_map.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace efzda;
+
+namespace {
+
+void test_covers() {
+    RegionMap map;
+    std::vector<uint8_t> heap(4096, 0x5A);
+    const uintptr_t a = reinterpret_cast<uintptr_t>(heap.data());
+    CHECK(map.covers(a, heap.size()));
+    const uint32_t queries = map.queries();
+    CHECK(queries >= 1);
+    CHECK(map.covers(a + 100, 16)); // cached: no new query
+    CHECK(map.queries() == queries);
+    CHECK(!map.covers(0, 4));
+    CHECK(!map.covers(a, 0));
+    CHECK(!map.covers(UINTPTR_MAX - 2, 8)); // wraps
+    CHECK(map.regionCount() > 0);
+
+    const uint32_t gen = map.generation();
+    map.invalidate();
+    CHECK(map.generation() == gen + 1);
+    CHECK(map.regionCount() == 0);
+    CHECK(map.covers(a, 4));
+    CHECK(map.queries() == queries + 1);
+}
+
+void test_unreadable_page() {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* p = mmap(nullptr, page * 3, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    CHECK(p != MAP_FAILED);
+    if (p == MAP_FAILED) return;
+    uint8_t* base = static_cast<uint8_t*>(p);
+    CHECK(mprotect(base + page, page, PROT_NONE) == 0);
+    const uintptr_t a = reinterpret_cast<uintptr_t>(base);
+
+    RegionMap map;
+    CHECK(map.covers(a, page));
+    CHECK(!map.covers(a + page, 1));
+    CHECK(!map.covers(a + page - 4, 8)); // straddles into the hole
+    CHECK(map.covers(a + 2 * page, page));
+
+    RegionMapMemorySource src;
+    std::memcpy(base + page - 4, "abcd", 4);
+    char out[8] = {};
+    CHECK(src.read(a + page - 4, out, 4) && std::memcmp(out, "abcd", 4) == 0);
+    CHECK(!src.read(a + page - 4, out, 8));
+    CHECK(src.stats().reads == 2 && src.stats().failures == 1);
+    munmap(p, page * 3);
+}
+
+void test_max_age() {
+    RegionMap map(std::chrono::milliseconds(1));
+    int local = 1;
+    const uintptr_t a = reinterpret_cast<uintptr_t>(&local);
+    CHECK(map.covers(a, sizeof(local)));
+    const uint32_t queries = map.queries();
+    const uint32_t gen = map.generation();
+    std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+    while (std::chrono::steady_clock::now() < until) {}
+    CHECK(map.covers(a, sizeof(local)));
+    CHECK(map.generation() == gen + 1);
+    CHECK(map.queries() == queries + 1);
+}
+
+} // namespace
+
+int main() {
+    test_covers();
+    test_unreadable_page();
+    test_max_age();
+    return efzda_test::check_result("region_map_test");
+}
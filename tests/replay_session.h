@@ -0,0 +1,88 @@
+#pragma once
+// A recorded vanilla (no EfzRevival) session for GameStateProvider::replay():
+// title screen, VS CPU character select, a match, and back to the title.
+// Shared by the replay test and the trace benchmark.
+#include "memory/snapshot_file.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+
+namespace efzda_test {
+
+// Addresses of the recorded efz.exe; nothing is mapped there, every read is
+// served from the file.
+constexpr uintptr_t kReplayEfzBase = 0x00400000;
+constexpr uintptr_t kReplayGlobals = kReplayEfzBase + 0x390100; // P1/P2/game-state slots and the screen index
+constexpr uint32_t kReplayP1Word = 0x10000000;
+constexpr uint32_t kReplayP2Word = 0x10001000;
+constexpr uint32_t kReplayGameStateWord = 0x20000000;
+
+struct ReplayFrame {
+    uint64_t tick;
+    uint8_t screen;   // EFZ screen index: 0 title, 1 character select, 3 in game
+    uint8_t gameMode; // 3 = VS CPU
+    bool spawned;     // both character slots filled
+};
+
+constexpr ReplayFrame kReplaySession[] = {
+    {1000, 0, 0xFF, false},
+    {1500, 1, 3, false},
+    {2000, 3, 3, true},
+    {2100, 3, 3, true},
+    {2600, 3, 3, true},
+    {3000, 0, 3, false},
+};
+constexpr size_t kReplaySessionPolls = std::size(kReplaySession);
+constexpr uint64_t kReplaySessionMs = 2500; // tick span of one round
+
+inline uintptr_t replay_slot(const uint8_t* globals, size_t offset) {
+    uintptr_t v = 0;
+    std::memcpy(&v, globals + offset, sizeof(v));
+    return v;
+}
+
+// The slots are 32-bit words 4 bytes apart. The provider reads them as
+// uintptr_t, so in a 64-bit build each read also takes the next word; the
+// structures are recorded wherever those reads point.
+inline bool write_replay_poll(efzda::SnapshotWriter& w, uint32_t poll, uint64_t tick, const ReplayFrame& f) {
+    efzda::SnapshotPollHeader h{};
+    h.poll = poll;
+    h.tick = tick;
+    h.efzBase = kReplayEfzBase;
+    w.beginPoll(h);
+
+    uint8_t globals[0x50] = {};
+    const uint32_t words[3] = {f.spawned ? kReplayP1Word : 0, f.spawned ? kReplayP2Word : 0, kReplayGameStateWord};
+    std::memcpy(globals + 0x04, words, sizeof(words));
+    globals[0x48] = f.screen;
+    w.addRead(kReplayGlobals, globals, sizeof(globals), true);
+
+    if (f.spawned) {
+        char name[12] = "akiko";
+        w.addRead(replay_slot(globals, 0x04) + 0x94, name, sizeof(name), true);
+        std::memset(name, 0, sizeof(name));
+        std::memcpy(name, "mayu", 4);
+        w.addRead(replay_slot(globals, 0x08) + 0x94, name, sizeof(name), true);
+    }
+    w.addRead(replay_slot(globals, 0x0C) + 0x1364, &f.gameMode, 1, true);
+    return w.endPoll();
+}
+
+// Writes `rounds` copies of the session back to back to a new file.
+inline bool write_replay_session(const std::string& path, unsigned rounds = 1) {
+    std::remove(path.c_str()); // the writer appends to an existing file
+    efzda::SnapshotWriter w;
+    if (!w.open(path)) return false;
+    uint32_t poll = 1;
+    for (unsigned r = 0; r < rounds; ++r) {
+        for (const ReplayFrame& f : kReplaySession) {
+            if (!write_replay_poll(w, poll++, f.tick + r * kReplaySessionMs, f)) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace efzda_test
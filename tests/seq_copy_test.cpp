@@ -0,0 +1,141 @@
+// SeqCopyReader: sequence/unchanged bookkeeping, then a stress run against
+// a writer thread rewriting the block in place as fast as it can.
+#include "check.h"
+
+#include "memory/seq_copy.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace efzda;
+
+namespace {
+
+constexpr size_t kBlock = 256;
+constexpr size_t kSeqAt = 6; // deliberately unaligned
+
+void put_seq(volatile uint8_t* block, uint32_t seq) {
+    for (size_t i = 0; i < 4; ++i) block[kSeqAt + i] = static_cast<uint8_t>(seq >> (8 * i));
+}
+
+// Every byte outside the sequence field carries the low byte of the
+// sequence, so a copy mixing two updates is easy to spot.
+bool consistent(const uint8_t* copy) {
+    uint32_t seq;
+    std::memcpy(&seq, copy + kSeqAt, sizeof(seq));
+    for (size_t i = 0; i < kBlock; ++i) {
+        if (i >= kSeqAt && i < kSeqAt + 4) continue;
+        if (copy[i] != static_cast<uint8_t>(seq)) return false;
+    }
+    return true;
+}
+
+void test_sequence_bookkeeping() {
+    uint8_t block[kBlock];
+    std::memset(block, 1, sizeof(block));
+    put_seq(block, 1);
+
+    SeqCopyReader reader;
+    CHECK(!reader.valid());
+    CHECK(reader.read(block, kBlock, kSeqAt) == SeqCopyReader::Result::Copied);
+    CHECK(reader.valid() && reader.size() == kBlock && reader.seq() == 1);
+    CHECK(consistent(reader.data()));
+
+    // Payload rewritten without a sequence move is not seen: that is the
+    // point of the fast path.
+    block[100] = 9;
+    CHECK(reader.read(block, kBlock, kSeqAt) == SeqCopyReader::Result::Unchanged);
+    CHECK(reader.data()[100] == 1);
+
+    std::memset(block, 2, sizeof(block));
+    put_seq(block, 2);
+    CHECK(reader.read(block, kBlock, kSeqAt) == SeqCopyReader::Result::Copied);
+    CHECK(reader.seq() == 2 && reader.data()[100] == 2);
+
+    CHECK(reader.read(nullptr, kBlock, kSeqAt) == SeqCopyReader::Result::Torn);
+    CHECK(reader.read(block, 0, kSeqAt) == SeqCopyReader::Result::Torn);
+    static uint8_t big[SeqCopyReader::kMaxSize + 1];
+    CHECK(reader.read(big, sizeof(big), kSeqAt) == SeqCopyReader::Result::Torn);
+    CHECK(reader.valid() && reader.seq() == 2); // failures keep the last copy
+    CHECK(reader.stats().failed == 3);
+
+    // Without a sequence field every read copies.
+    CHECK(reader.read(block, kBlock, SeqCopyReader::kNoSeq) == SeqCopyReader::Result::Copied);
+    CHECK(reader.read(block, kBlock, SeqCopyReader::kNoSeq) == SeqCopyReader::Result::Copied);
+    // A sequence offset past the end counts as none.
+    CHECK(reader.read(block, kBlock, kBlock - 2) == SeqCopyReader::Result::Copied);
+
+    reader.reset();
+    CHECK(!reader.valid());
+    CHECK(reader.read(block, kBlock, kSeqAt) == SeqCopyReader::Result::Copied);
+}
+
+// `pause` is the writer's idle time between updates; zero rewrites the
+// block back to back with no gap at all.
+void run_against_writer(std::chrono::microseconds pause, bool expectAccepted) {
+    alignas(8) static volatile uint8_t block[kBlock];
+    for (size_t i = 0; i < kBlock; ++i) block[i] = 0;
+    put_seq(block, 0);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> updates{0};
+    // The payload is written around the sequence field, the way the export
+    // is updated field by field with no begin/end marker.
+    std::thread writer([&] {
+        uint32_t seq = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            ++seq;
+            const uint8_t b = static_cast<uint8_t>(seq);
+            for (size_t i = 0; i < kSeqAt; ++i) block[i] = b;
+            put_seq(block, seq);
+            for (size_t i = kSeqAt + 4; i < kBlock; ++i) block[i] = b;
+            updates.fetch_add(1, std::memory_order_relaxed);
+            if (pause.count()) std::this_thread::sleep_for(pause);
+        }
+    });
+
+    SeqCopyReader reader;
+    uint64_t accepted = 0, inconsistent = 0, reads = 0;
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    while (std::chrono::steady_clock::now() < until) {
+        ++reads;
+        if (reader.read(const_cast<const uint8_t*>(block), kBlock, kSeqAt) != SeqCopyReader::Result::Copied) continue;
+        ++accepted;
+        if (!consistent(reader.data())) ++inconsistent;
+    }
+    stop = true;
+    writer.join();
+
+    const SeqCopyStats& s = reader.stats();
+    std::printf("seq_copy stress (%lld us pause): %llu writer updates, %llu reads, %llu accepted, %llu torn attempts, "
+                "%llu failed reads, %llu inconsistent copies accepted\n",
+                static_cast<long long>(pause.count()), static_cast<unsigned long long>(updates.load()), static_cast<unsigned long long>(reads),
+                static_cast<unsigned long long>(accepted), static_cast<unsigned long long>(s.torn),
+                static_cast<unsigned long long>(s.failed), static_cast<unsigned long long>(inconsistent));
+    CHECK(updates.load() > 0);
+    CHECK(!expectAccepted || accepted > 0);
+    // The writer really raced the reader, and the reader caught it.
+    CHECK(s.torn > 0);
+    // The documented blind spot (a writer stalled across both copies and
+    // the pause between them) is allowed, but must stay rare among the
+    // copy attempts.
+    CHECK(inconsistent * 100 <= accepted + s.torn);
+}
+
+void test_against_fast_writer() {
+    // Far faster than the game's once-per-frame export, with gaps.
+    run_against_writer(std::chrono::microseconds(100), true);
+    // Never idle: nothing may be accepted torn, even if nothing is accepted.
+    run_against_writer(std::chrono::microseconds(0), false);
+}
+
+} // namespace
+
+int main() {
+    test_sequence_bookkeeping();
+    test_against_fast_writer();
+    return efzda_test::check_result("seq_copy_test");
+}
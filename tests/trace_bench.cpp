@@ -0,0 +1,86 @@
+// Cost of the trace sites in GameStateProvider::get(), measured by replaying
+// a recorded session (replay_session.h) with the fingerprint short-circuit
+// off, so every poll runs the full decode. Built twice from this file:
+//
+//   trace_bench         trace sites compiled out (EFZDA_ENABLE_LOGGING=0)
+//   trace_bench_traced  compiled in; runs once with every category masked
+//                       and once with all of them at verbose
+//
+// The log sink here only formats the line into a buffer, so "verbose" is
+// the formatting cost without the file write.
+#include "check.h"
+#include "replay_session.h"
+
+#include "state/game_state_provider.h"
+#include "trace.h"
+
+#include <unistd.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+unsigned long g_logLines = 0;
+} // namespace
+
+namespace efzda {
+void log(const char* fmt, ...) {
+    char buf[1024];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    efzda_test::keep(buf[0]);
+    ++g_logLines;
+}
+void logw(const wchar_t*, ...) {}
+} // namespace efzda
+
+using namespace efzda;
+
+namespace {
+
+// Prints the cost per get() with the file load (measured separately) taken out.
+void bench_get(const char* name, const std::string& path, unsigned long replays, double loadNs) {
+    GameStateProvider provider;
+    std::vector<ReplayedPoll> timeline;
+    provider.replay(path, timeline); // warm up sticky state and the file cache
+    const size_t polls = timeline.size();
+    g_logLines = 0;
+    const double perReplay = efzda_test::bench(name, replays, [&] { provider.replay(path, timeline); });
+    std::printf("%-40s %10zu polls %12.1f ns/get() %8.1f lines/get()\n", "", polls,
+                polls ? (perReplay - loadNs) / static_cast<double>(polls) : 0.0,
+                polls && replays ? static_cast<double>(g_logLines) / static_cast<double>(polls * replays) : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const bool quick = efzda_test::quick_run(argc, argv);
+    const unsigned long replays = quick ? 2 : 200;
+    setenv("EFZDA_FINGERPRINT_MAX_AGE_MS", "0", 1);
+
+    char dir[] = "/tmp/efzda-trace-XXXXXX";
+    if (!::mkdtemp(dir)) return 1;
+    const std::string path = std::string(dir) + "/session.efzsnap";
+    if (!efzda_test::write_replay_session(path, 100)) return 1;
+
+    SnapshotReader reader;
+    const double loadNs = efzda_test::bench("snapshot load only", replays, [&] { efzda_test::keep(reader.load(path)); });
+#if EFZDA_ENABLE_LOGGING
+    set_trace_mask(0);
+    bench_get("get(), trace sites masked", path, replays, loadNs);
+    set_trace_mask((1u << kTraceCategoryCount) - 1);
+    for (size_t c = 0; c < kTraceCategoryCount; ++c) set_trace_level(static_cast<TraceCategory>(c), TraceLevel::Verbose);
+    bench_get("get(), all categories verbose", path, replays, loadNs);
+#else
+    bench_get("get(), trace sites compiled out", path, replays, loadNs);
+#endif
+
+    ::unlink(path.c_str());
+    ::rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,159 @@
+// EventFdWaitSource and PollScheduler::wait() on the POSIX backend: a
+// signalled notify source ends the wait with PollWake::Notify, wake() with
+// PollWake::Wake, and otherwise the interval elapses, also when the notify
+// descriptor has hung up.
+#include "check.h"
+
+#include "poll_scheduler.h"
+#include "wait_source.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+using namespace efzda;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long long elapsed_ms(Clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+}
+
+void test_wait_source() {
+    EventFdWaitSource src;
+    CHECK(src.isOpen());
+    CHECK(!src.wait(0));
+    src.signal();
+    src.signal(); // collapses into one
+    CHECK(src.wait(0));
+    CHECK(!src.wait(0));
+
+    const Clock::time_point t0 = Clock::now();
+    CHECK(!src.wait(30));
+    CHECK(elapsed_ms(t0) >= 25);
+
+    std::thread signaller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        src.signal();
+    });
+    CHECK(src.wait(2000));
+    signaller.join();
+}
+
+void test_scheduler_notify() {
+    PollSchedulerConfig cfg;
+    cfg.fastMs = 1000; // long enough that only a signal can end the wait early
+    cfg.notifyMinGapMs = 0;
+    PollScheduler scheduler(cfg);
+    EventFdWaitSource notify;
+    scheduler.setNotifySource(&notify);
+
+    // Signalled before the wait: picked up at once.
+    notify.signal();
+    Clock::time_point t0 = Clock::now();
+    CHECK(scheduler.wait() == PollWake::Notify);
+    CHECK(elapsed_ms(t0) < 500);
+    CHECK(scheduler.stats().notifyWakeups == 1);
+
+    // Signalled from another thread during the wait.
+    std::thread signaller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        notify.signal();
+    });
+    t0 = Clock::now();
+    CHECK(scheduler.wait() == PollWake::Notify);
+    CHECK(elapsed_ms(t0) < 500);
+    signaller.join();
+
+    std::thread waker([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        scheduler.wake();
+    });
+    CHECK(scheduler.wait() == PollWake::Wake);
+    waker.join();
+    CHECK(scheduler.stats().notifyWakeups == 2);
+}
+
+void test_scheduler_timer() {
+    PollSchedulerConfig cfg;
+    cfg.fastMs = 40;
+    PollScheduler scheduler(cfg);
+    EventFdWaitSource notify;
+    scheduler.setNotifySource(&notify);
+    const Clock::time_point t0 = Clock::now();
+    CHECK(scheduler.wait() == PollWake::Timer);
+    CHECK(elapsed_ms(t0) >= 35);
+
+    scheduler.setNotifySource(nullptr);
+    notify.signal(); // no longer watched
+    CHECK(scheduler.wait() == PollWake::Timer);
+}
+
+void test_notify_coalescing() {
+    // A notification right after a poll is held until notifyMinGapMs has
+    // passed since that poll.
+    PollSchedulerConfig cfg;
+    cfg.fastMs = 1000;
+    cfg.notifyMinGapMs = 80;
+    PollScheduler scheduler(cfg);
+    EventFdWaitSource notify;
+    scheduler.setNotifySource(&notify);
+    scheduler.onPoll(true, false);
+    const Clock::time_point t0 = Clock::now();
+    notify.signal();
+    CHECK(scheduler.wait() == PollWake::Notify);
+    CHECK(elapsed_ms(t0) >= 60);
+}
+
+// Notify source on the read end of a pipe whose writer is gone: poll()
+// reports POLLHUP on it forever and it never becomes readable.
+class HungUpWaitSource final : public WaitSource {
+public:
+    HungUpWaitSource() {
+        int fds[2];
+        if (::pipe(fds) == 0) {
+            ::close(fds[1]);
+            m_fd = fds[0];
+        }
+    }
+    ~HungUpWaitSource() override {
+        if (m_fd >= 0) ::close(m_fd);
+    }
+    bool isOpen() const override { return m_fd >= 0; }
+    void signal() override {}
+    bool wait(uint32_t) override { return false; }
+    uintptr_t nativeHandle() const override { return static_cast<uintptr_t>(m_fd); }
+
+private:
+    int m_fd = -1;
+};
+
+void test_hung_up_notify() {
+    PollSchedulerConfig cfg;
+    cfg.fastMs = 200;
+    PollScheduler scheduler(cfg);
+    HungUpWaitSource notify;
+    CHECK(notify.isOpen());
+    scheduler.setNotifySource(&notify);
+    const Clock::time_point t0 = Clock::now();
+    const std::clock_t cpu0 = std::clock();
+    CHECK(scheduler.wait() == PollWake::Timer);
+    const double cpuMs = 1000.0 * static_cast<double>(std::clock() - cpu0) / CLOCKS_PER_SEC;
+    CHECK(elapsed_ms(t0) >= 190);
+    CHECK(cpuMs < 100); // waited, did not spin on POLLHUP
+}
+
+} // namespace
+
+int main() {
+    test_wait_source();
+    test_scheduler_notify();
+    test_scheduler_timer();
+    test_notify_coalescing();
+    test_hung_up_notify();
+    return efzda_test::check_result("wait_source_test");
+}